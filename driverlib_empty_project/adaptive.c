@@ -0,0 +1,177 @@
+/*
+ * adaptive.c
+ *
+ * See adaptive.h.  Only the number of points each coarse interval gets is
+ * kept, not the frequencies; sweepPointFrequency() walks the intervals
+ * with a cursor, which costs nothing when the points are asked for in
+ * order as the sweep, the SOL interpolation and the output all do.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "vna.h"
+#include "uartQueue.h"
+#include "stream.h"
+#include "crc16.h"
+#include "sweep.h"
+#include "adaptive.h"
+
+#define FREQUENCY_LIST_HEADER_BYTES	4
+
+static bool adaptive;			/* F with a budget. */
+static bool refined;			/* The coarse sweep is done. */
+static uint16_t coarse;
+static uint16_t budget;
+static uint32_t change[ADAPT_MAX_COARSE_POINTS];	/* Across each coarse interval. */
+static uint16_t extra[ADAPT_MAX_COARSE_POINTS];		/* Points inside each interval. */
+static uint16_t previous[NUM_ADC14_CHANNELS];
+
+/* Where sweepPointFrequency() was last asked for. */
+static uint16_t cursorInterval;
+static uint16_t cursorIndex;	/* Of the interval's coarse point. */
+
+void adaptiveStart(uint16_t coarsePoints, uint16_t numPoints)
+{
+	coarse = coarsePoints;
+	budget = numPoints;
+	refined = false;
+	adaptive = true;
+}
+
+void adaptiveStop(void)
+{
+	adaptive = false;
+	refined = false;
+}
+
+bool adaptiveRefined(void)
+{
+	return refined;
+}
+
+static long int coarseFrequency(uint16_t index)
+{
+	return sweepPlan.startFrequency + (long int)(((long long)(sweepPlan.stopFrequency
+			- sweepPlan.startFrequency) * index) / (coarse - 1));
+}
+
+long int adaptiveFrequency(uint16_t index)
+{
+	long int low;
+
+	if(index < cursorIndex)
+	{
+		cursorInterval = 0;
+		cursorIndex = 0;
+	}
+	while((cursorInterval < coarse - 1) &&
+			(index > cursorIndex + extra[cursorInterval]))
+	{
+		cursorIndex += extra[cursorInterval] + 1;
+		cursorInterval++;
+	}
+	low = coarseFrequency(cursorInterval);
+	if(index == cursorIndex)
+		return low;
+	return low + (long int)(((long long)(coarseFrequency(cursorInterval + 1) - low)
+			* (index - cursorIndex)) / (extra[cursorInterval] + 1));
+}
+
+/* How far apart two sets of results are, summed over the channels. */
+static uint32_t distance(const uint16_t *a, const uint16_t *b)
+{
+	uint32_t sum = 0;
+	int c;
+
+	for(c = 0; c < NUM_ADC14_CHANNELS; c++)
+		sum += (a[c] > b[c]) ? a[c] - b[c] : b[c] - a[c];
+	return sum;
+}
+
+/* Called with every point's corrected results; only the coarse sweep's
+ * are looked at. */
+#pragma CODE_SECTION(adaptivePoint, ".sramcode")
+void adaptivePoint(uint16_t index, const uint16_t *results)
+{
+	int c;
+
+	if(!adaptive | refined)
+		return;
+	if(index != 0)
+		change[index - 1] = distance(previous, results);
+	for(c = 0; c < NUM_ADC14_CHANNELS; c++)
+		previous[c] = results[c];
+}
+
+/*
+ * Share the points left over between the coarse intervals in proportion
+ * to how much more each changes than the flattest, rounding the running
+ * total so the shares add up exactly.  If nothing stands out they are
+ * shared evenly.
+ */
+static void refine(void)
+{
+	uint32_t flattest = 0xFFFFFFFF;
+	uint64_t total = 0, sum = 0, divisor;
+	uint16_t spare = budget - coarse, given = 0, reached;
+	uint16_t i, intervals = coarse - 1;
+
+	for(i = 0; i < intervals; i++)
+		if(change[i] < flattest)
+			flattest = change[i];
+	for(i = 0; i < intervals; i++)
+	{
+		change[i] -= flattest;
+		total += change[i];
+	}
+	divisor = total ? total : intervals;
+	for(i = 0; i < intervals; i++)
+	{
+		sum += total ? change[i] : 1;
+		reached = (uint16_t)((sum * spare + divisor / 2) / divisor);
+		extra[i] = reached - given;
+		given = reached;
+	}
+	cursorInterval = 0;
+	cursorIndex = 0;
+}
+
+/*
+ * Returns true when the sweep just finished was the coarse one and the
+ * plan is now the refined list of the plan's adaptivePoints.
+ */
+bool adaptiveEndSweep(bool complete)
+{
+	if(!adaptive | refined | !complete)
+		return false;
+	refine();
+	refined = true;
+	return true;
+}
+
+void sendFrequencyList(void)
+{
+	uint8_t bytes[FREQUENCY_LIST_HEADER_BYTES + STREAM_CRC_BYTES];
+	uint16_t i, crc = CRC16_INIT;
+	uint32_t frequency;
+
+	bytes[0] = STREAM_SYNC;
+	bytes[1] = STREAM_FREQUENCY_LIST;
+	bytes[2] = (uint8_t)sweepPlan.numPoints;
+	bytes[3] = (uint8_t)(sweepPlan.numPoints >> 8);
+	while(uartQueueFree() < FREQUENCY_LIST_HEADER_BYTES + STREAM_CRC_BYTES);
+	streamWriteFrame(bytes, FREQUENCY_LIST_HEADER_BYTES);
+
+	for(i = 0; i < sweepPlan.numPoints; i++)
+	{
+		frequency = (uint32_t)sweepPointFrequency(i);
+		bytes[0] = (uint8_t)frequency;
+		bytes[1] = (uint8_t)(frequency >> 8);
+		bytes[2] = (uint8_t)(frequency >> 16);
+		bytes[3] = (uint8_t)(frequency >> 24);
+		crc = streamSendBytes(bytes, 4, crc);
+	}
+	streamSendCrc(crc);
+}
@@ -0,0 +1,42 @@
+/*
+ * adaptive.h
+ *
+ * Adaptive sweeps for finding narrow resonances without a fine grid over
+ * the whole span.  "F start stop coarse budget" first sweeps coarse
+ * linearly spaced points as usual.  When that sweep completes, the change
+ * in S11 and S21 across each coarse interval, less the change across the
+ * flattest one, decides how the rest of the budget is shared out, and
+ * every later sweep measures the coarse points plus that interval's share
+ * spaced evenly inside it, budget points in all, in frequency order.  The
+ * list stays put until the plan is set again, so averaging, the store and
+ * change detection work on it as on any plan.
+ *
+ * Sweeps on a refined list are flagged STREAM_FLAG_ADAPTIVE.  Touchstone
+ * output gives every point's frequency; for the other formats "F" sends
+ * the present plan's frequencies, adaptive or not:
+ *
+ *   STREAM_SYNC, STREAM_FREQUENCY_LIST, numPoints(2), crc(2),
+ *   frequency(4) * numPoints, crc(2)
+ *
+ * the second CRC again over what follows the first.  The time domain
+ * transform needs evenly spaced points and skips refined sweeps, and
+ * calibration standards can only be captured on a uniform plan.
+ */
+
+#ifndef ADAPTIVE_H_
+#define ADAPTIVE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ADAPT_MAX_COARSE_POINTS	128
+
+void adaptiveStart(uint16_t coarsePoints, uint16_t numPoints);
+void adaptiveStop(void);
+bool adaptiveRefined(void);
+long int adaptiveFrequency(uint16_t index);
+void adaptivePoint(uint16_t index, const uint16_t *results);
+bool adaptiveEndSweep(bool complete);
+void sendFrequencyList(void);
+
+#endif /* ADAPTIVE_H_ */
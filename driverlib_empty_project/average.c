@@ -0,0 +1,134 @@
+/*
+ * average.c
+ *
+ * See average.h.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "vna.h"
+#include "sweep.h"
+#include "average.h"
+
+static int32_t accumulators[AVG_MAX_POINTS][NUM_ADC14_CHANNELS];
+static AverageMode averageMode = AVERAGE_OFF;
+static uint16_t averageN;			/* Shift, or sweeps per block. */
+static uint16_t averageEvery;
+static SweepPlan averagePlan;
+static uint32_t sweepsAveraged;		/* Since the start, or in this block. */
+static bool averaging;				/* This sweep goes into the average. */
+static bool sendThis;				/* And the average goes out with it. */
+static bool sendRequested;
+
+/*
+ * n is the shift for exponential averaging and the number of sweeps for
+ * block averaging.  sendEvery only applies to exponential averaging.
+ */
+bool setAveraging(AverageMode mode, uint16_t n, uint16_t sendEvery)
+{
+	if((mode == AVERAGE_EXPONENTIAL) & ((n < 1) | (n > AVG_MAX_SHIFT)))
+		return false;
+	if((mode == AVERAGE_BLOCK) & ((n < 1) | (n > AVG_MAX_BLOCK)))
+		return false;
+	averageMode = mode;
+	averageN = n;
+	averageEvery = sendEvery;
+	sweepsAveraged = 0;
+	sendRequested = false;
+	return true;
+}
+
+void getAveraging(AverageMode *mode, uint16_t *n, uint16_t *sendEvery)
+{
+	*mode = averageMode;
+	*n = averageN;
+	*sendEvery = averageEvery;
+}
+
+/* Send the exponential average with the next complete sweep. */
+void averageRequestSend(void)
+{
+	sendRequested = true;
+}
+
+/*
+ * Returns true if this sweep is to be sent, which is always the case
+ * when not averaging.
+ */
+bool averageBeginSweep(void)
+{
+	averaging = (averageMode != AVERAGE_OFF) & (sweepPlan.numPoints <= AVG_MAX_POINTS);
+	if(!averaging)
+		return true;
+
+	if(!samePlan(&sweepPlan, &averagePlan))
+	{
+		averagePlan = sweepPlan;
+		sweepsAveraged = 0;
+	}
+
+	if(averageMode == AVERAGE_BLOCK)
+		sendThis = (sweepsAveraged + 1 >= averageN);
+	else
+		sendThis = sendRequested | (averageEvery &&
+				((sweepsAveraged + 1) % averageEvery == 0));
+	return sendThis;
+}
+
+#pragma CODE_SECTION(averagePoint, ".sramcode")
+void averagePoint(uint16_t index, uint16_t *results)
+{
+	int32_t *acc;
+	int c;
+
+	if(!averaging)
+		return;
+	acc = accumulators[index];
+	for(c = 0; c < NUM_ADC14_CHANNELS; c++)
+	{
+		if(averageMode == AVERAGE_EXPONENTIAL)
+		{
+			if(sweepsAveraged == 0)
+				acc[c] = (int32_t)results[c] << AVG_FRACTION_BITS;
+			else
+				acc[c] += (((int32_t)results[c] << AVG_FRACTION_BITS) - acc[c]) >> averageN;
+			if(sendThis)
+				results[c] = (uint16_t)((acc[c] + (1 << (AVG_FRACTION_BITS - 1)))
+						>> AVG_FRACTION_BITS);
+		}
+		else
+		{
+			if(sweepsAveraged == 0)
+				acc[c] = results[c];
+			else
+				acc[c] += results[c];
+			if(sendThis)
+				results[c] = (uint16_t)((acc[c] + averageN / 2) / averageN);
+		}
+	}
+}
+
+/*
+ * An incomplete sweep leaves some points a sweep behind; harmless for
+ * the exponential average, but a block has to start again.
+ */
+void averageEndSweep(bool complete)
+{
+	if(!averaging)
+		return;
+	averaging = false;
+	if(!complete)
+	{
+		if(averageMode == AVERAGE_BLOCK)
+			sweepsAveraged = 0;
+		return;
+	}
+	if(sendThis)
+		sendRequested = false;
+	if((averageMode == AVERAGE_BLOCK) & sendThis)
+		sweepsAveraged = 0;
+	else
+		sweepsAveraged++;
+}
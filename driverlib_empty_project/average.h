@@ -0,0 +1,41 @@
+/*
+ * average.h
+ *
+ * Averaging across sweeps, in the sweep loop, so the host only gets the
+ * averaged result.  There is one accumulator per channel per point for
+ * plans of up to AVG_MAX_POINTS points; longer plans are sent raw.
+ *
+ *   Exponential: avg += (x - avg) / 2^k, shifts only.  The average goes
+ *   out every e sweeps, or with e = 0 only when the host asks with "A".
+ *   Block: the sum of n sweeps goes out divided by n, once per n sweeps.
+ *
+ * Sweeps that are not sent are neither streamed nor stored.  The sweep
+ * that goes out carries the average in place of its own readings, so the
+ * host sees an ordinary sweep.  Changing the plan starts again.
+ */
+
+#ifndef AVERAGE_H_
+#define AVERAGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AVG_MAX_POINTS		512
+#define AVG_FRACTION_BITS	8		/* Of the exponential accumulators. */
+#define AVG_MAX_SHIFT		12
+#define AVG_MAX_BLOCK		32768	/* Keeps a block sum inside an int32_t. */
+
+typedef enum {
+	AVERAGE_OFF = 0,
+	AVERAGE_EXPONENTIAL = 1,
+	AVERAGE_BLOCK = 2
+} AverageMode;
+
+bool setAveraging(AverageMode mode, uint16_t n, uint16_t sendEvery);
+void getAveraging(AverageMode *mode, uint16_t *n, uint16_t *sendEvery);
+void averageRequestSend(void);
+bool averageBeginSweep(void);
+void averagePoint(uint16_t index, uint16_t *results);
+void averageEndSweep(bool complete);
+
+#endif /* AVERAGE_H_ */
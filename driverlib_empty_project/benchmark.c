@@ -0,0 +1,193 @@
+/*
+ * benchmark.c
+ *
+ * See benchmark.h.  The scenarios run with averaging, limit testing, the
+ * store, TDR and change detection all off, so every run measures the same
+ * work.  Those, the sweep plan, output format, trigger mode, flow control
+ * state and stream counters are put back afterwards, though an average
+ * starts over; the tracepoint statistics are cleared for every scenario
+ * and are not.  A replay runs with everything as it is set, and leaves
+ * the raw recording stopped.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "busModel.h"
+#include "uartQueue.h"
+#include "stream.h"
+#include "sweep.h"
+#include "trace.h"
+#include "trigger.h"
+#include "sweepStore.h"
+#include "average.h"
+#include "limitMask.h"
+#include "tdr.h"
+#include "benchmark.h"
+
+#define NUM_BENCH_SIZES 4
+
+static const uint16_t benchSizes[NUM_BENCH_SIZES] = {101, 401, 1601, 10001};
+static const char *const formatNames[NUM_OUTPUT_FORMATS] = {"Ascii", "Binary", "Touchstone"};
+
+#define NUM_REPLAY_STAGES 4
+
+/* What a replayed point goes through, after the ADC. */
+static const Tracepoint replayStages[NUM_REPLAY_STAGES] = {
+	TRACE_SWEEP_POINT, TRACE_CORRECT_POINT, TRACE_STREAM_POINT, TRACE_TDR_TRANSFORM
+};
+static const char *const replayStageNames[NUM_REPLAY_STAGES] = {
+	"Point", "Correct", "Stream", "Tdr"
+};
+
+static void runScenario(uint16_t numPoints, bool allBands, OutputFormat format)
+{
+	BusConfig config;
+	SweepModel model;
+	BusPrediction prediction;
+	uint32_t start, cycles, sinkBytes;
+
+	if(allBands)
+		setSweepPlan(MIN_FREQUENCY, MAX_FREQUENCY, numPoints);
+	else
+		setSweepPlan(BENCH_SINGLE_BAND_START, BENCH_SINGLE_BAND_STOP, numPoints);
+	setOutputFormat(format);
+	clearTrace();
+
+	uartQueueSetSink(true);
+	start = TRACE_CYCLES();
+	startSweep(SWEEP_SINGLE);
+	while(getSweepMode() != SWEEP_IDLE)
+		serviceSweep();
+	cycles = TRACE_CYCLES() - start;
+	sinkBytes = uartSinkBytes;
+	uartQueueSetSink(false);
+
+	initializeBusConfig(&config);
+	model.numPoints = numPoints;
+	model.frequencyOf = sweepPointFrequency;
+	model.stageOrder = sweepStageOrder;
+	model.numStages = SWEEP_NUM_STAGES;
+	model.outputFormat = format;
+	model.bytesPerPoint = (uint16_t)(sinkBytes / numPoints);
+	model.blocking = true;
+	predictSweep(&config, &model, &prediction);
+
+	printf("Bench,%d,%s,%s,%n,%n,%n,%s,%n,%n\r\n", numPoints,
+			allBands ? "All" : "Single",
+			formatNames[format],
+			cycles / numPoints,
+			(uint32_t)(traceStats[TRACE_STREAM_POINT].totalCycles / numPoints),
+			(uint32_t)(prediction.sweepNs / numPoints),
+			busStageName(prediction.bottleneck),
+			sinkBytes / numPoints, sinkBytes);
+}
+
+void runBenchmarks(void)
+{
+	SweepPlan savedPlan = sweepPlan;
+	SweepMode savedMode = getSweepMode();
+	OutputFormat savedFormat = getOutputFormat();
+	StreamCounters savedCounters = streamCounters;
+	bool savedFlowControl = streamFlowControl();
+	uint16_t savedCredits = streamCredits();
+	TriggerMode savedTrigger = getTriggerMode();
+	LimitMode savedLimit = getLimitMode();
+	AverageMode savedAverage;
+	uint16_t savedAverageN, savedAverageEvery, savedThreshold, savedKeyframes;
+	TdrMode savedTdr;
+	TdrWindow savedWindow;
+	bool savedChanges;
+	int size, allBands, format;
+
+	getAveraging(&savedAverage, &savedAverageN, &savedAverageEvery);
+	getTdr(&savedTdr, &savedWindow);
+	getChangeDetection(&savedChanges, &savedThreshold, &savedKeyframes);
+
+	haltSweep();
+	streamDisableFlowControl();
+	setTriggerMode(TRIGGER_FREE);
+	setAveraging(AVERAGE_OFF, 0, 0);
+	setLimitMode(LIMIT_OFF);
+	storePause(true);
+	setTdr(TDR_OFF, savedWindow);
+	setChangeDetection(false, savedThreshold, savedKeyframes);
+
+	printf("BenchStart ClockHz %n\r\n", traceClockHz());
+	printf("Bench,Points,Range,Format,CyclesPerPoint,OutputCyclesPerPoint,"
+			"ModelNsPerPoint,ModelBottleneck,BytesPerPoint,Bytes\r\n");
+	for(size = 0; size < NUM_BENCH_SIZES; size++)
+		for(allBands = 0; allBands < 2; allBands++)
+			for(format = OUTPUT_ASCII; format < NUM_OUTPUT_FORMATS; format++)
+				runScenario(benchSizes[size], allBands, (OutputFormat)format);
+	printf("BenchEnd\r\n");
+
+	restoreSweepPlan(&savedPlan);
+	setOutputFormat(savedFormat);
+	setTriggerMode(savedTrigger);
+	setAveraging(savedAverage, savedAverageN, savedAverageEvery);
+	setLimitMode(savedLimit);
+	storePause(false);
+	setTdr(savedTdr, savedWindow);
+	setChangeDetection(savedChanges, savedThreshold, savedKeyframes);
+	streamCounters = savedCounters;
+	if(savedFlowControl)
+		streamGrantCredits(savedCredits);
+	if(savedMode != SWEEP_IDLE)
+		startSweep(savedMode);
+}
+
+bool runReplay(uint16_t repeats, bool paced)
+{
+	SweepPlan savedPlan = sweepPlan;
+	SweepMode savedMode = getSweepMode();
+	StreamCounters savedCounters = streamCounters;
+	bool savedFlowControl = streamFlowControl();
+	uint16_t savedCredits = streamCredits();
+	uint32_t start, cycles, sinkBytes, sweeps, points;
+	int i;
+
+	streamDisableFlowControl();
+	if(!startReplay(repeats, paced))
+	{
+		if(savedFlowControl)
+			streamGrantCredits(savedCredits);
+		return false;
+	}
+	sweeps = (uint32_t)storeRawSweeps() * repeats;
+	clearTrace();
+
+	uartQueueSetSink(true);
+	start = TRACE_CYCLES();
+	while(getSweepMode() != SWEEP_IDLE)
+		serviceSweep();
+	cycles = TRACE_CYCLES() - start;
+	sinkBytes = uartSinkBytes;
+	uartQueueSetSink(false);
+
+	points = traceStats[TRACE_SWEEP_POINT].count;
+	if(points == 0)
+		points = 1;
+	printf("Replay Sweeps %n Points %n CyclesPerPoint %n BytesPerPoint %n\r\n",
+			sweeps, traceStats[TRACE_SWEEP_POINT].count, cycles / points,
+			sinkBytes / points);
+	printf("Replay,Stage,Count,CyclesPerCall\r\n");
+	for(i = 0; i < NUM_REPLAY_STAGES; i++)
+	{
+		TraceStats *stats = &traceStats[replayStages[i]];
+
+		printf("Replay,%s,%n,%n\r\n", replayStageNames[i], stats->count,
+				stats->count ? (uint32_t)(stats->totalCycles / stats->count) : 0);
+	}
+
+	restoreSweepPlan(&savedPlan);
+	streamCounters = savedCounters;
+	if(savedFlowControl)
+		streamGrantCredits(savedCredits);
+	if(savedMode != SWEEP_IDLE)
+		startSweep(savedMode);
+	return true;
+}
@@ -0,0 +1,43 @@
+/*
+ * benchmark.h
+ *
+ * Standard sweep benchmarks, run on the instrument with the 'B' command.
+ * Every combination of 101, 401, 1601 and 10001 points, one VersaClock
+ * band or the whole DDS range, and ASCII, binary or Touchstone output is
+ * swept once through the normal sweep and stream code with the UART
+ * queue in sink mode, so the numbers are CPU and bus time without the
+ * wait for the serial link.  The link's share is added back by the bus
+ * timing model.
+ *
+ * Results are printed as CSV, one line per scenario after a header line,
+ * so a captured log can be diffed between firmware revisions:
+ *
+ *   Bench,Points,Range,Format,CyclesPerPoint,OutputCyclesPerPoint,
+ *       ModelNsPerPoint,ModelBottleneck,BytesPerPoint,Bytes
+ *
+ * 'B 1 n' replays the raw sweeps recorded with 'G k 2' (sweepStore.h) n
+ * times over through everything after the ADC, with the present output
+ * format, corrections and options, again into the sink.  So one recording
+ * of real readings can be run through the processing before and after a
+ * change and the results and cycle counts compared.  'B 1 n 1' keeps to
+ * the pace the sweeps were recorded at, which shows whether the processing
+ * keeps up with the hardware.  Sweeps recorded on a refined adaptive plan
+ * (adaptive.h) are refused.  It prints
+ *
+ *   Replay Sweeps s Points p CyclesPerPoint c BytesPerPoint b
+ *   Replay,Stage,Count,CyclesPerCall
+ *
+ * and then one line for each processing stage.
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+/* The single band scenarios stay inside VersaClock band 0. */
+#define BENCH_SINGLE_BAND_START	1000000L
+#define BENCH_SINGLE_BAND_STOP	2900000L
+
+void runBenchmarks(void);
+bool runReplay(uint16_t repeats, bool paced);
+
+#endif /* BENCHMARK_H_ */
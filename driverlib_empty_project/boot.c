@@ -0,0 +1,110 @@
+/*
+ * boot.c
+ *
+ * Dependencies: everything needs the clocks; the VersaClock registers
+ * need the I2C bus and the 10 ms power-up time; the DDS, I2C bus set-up
+ * and UART need neither, so they run inside the power-up wait.
+ *
+ * initializeADC() puts P5.4 and P5.5 into analog mode and
+ * initializeVersaclock() then takes them back as the CKSEL and SD outputs.
+ * The original boot left them as outputs, so the ADC still goes first to
+ * keep the pins as they were.
+ */
+
+/* DriverLib Includes */
+#include "driverlib.h"
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "timer.h"
+#include "uartQueue.h"
+#include "calStore.h"
+#include "boot.h"
+
+uint32_t bootMicroseconds[NUM_BOOT_STAGES];
+uint32_t bootTotalMicroseconds;
+uint16_t bootFailures;
+
+static const char *bootStageNames[NUM_BOOT_STAGES] = {
+	"Uart", "Adc", "VersaclockPower", "Dds", "I2c", "Calibration", "VersaclockWait",
+	"VersaclockRegs"
+};
+
+static int writeVersaclockRegs(void)
+{
+	return initCDCE();
+}
+
+static bool runBootStage(BootStage stage, int (*initialize)(void))
+{
+	uint32_t start = timerTicks();
+	int attempt;
+	bool succeeded = false;
+
+	for(attempt = 0; (attempt < BOOT_RETRIES) & !succeeded; attempt++)
+	{
+		if(attempt != 0)
+			delayMicroseconds(BOOT_RETRY_US);
+		succeeded = initialize();
+	}
+	bootMicroseconds[stage] = ticksToMicroseconds(timerTicks() - start);
+	if(!succeeded)
+		bootFailures |= 1 << stage;
+	return succeeded;
+}
+
+void bootInstrument(void)
+{
+	uint32_t bootStart, powerUpStart, waitStart;
+
+	/* Output queued before the UART is up goes out once it is. */
+	initializeUartQueue();
+	initializeClocks();
+	initializeTimer();
+	bootStart = timerTicks();
+	bootFailures = 0;
+
+	runBootStage(BOOT_ADC, initializeADC);
+	runBootStage(BOOT_VERSACLOCK_POWER, initializeVersaclock);
+	powerUpStart = timerTicks();
+
+	/* Independent set-up, overlapped with the VersaClock power-up. */
+	runBootStage(BOOT_UART, initializeBackChannelUART);
+	/* The UART transmit queue drains from its interrupt, so interrupts
+	 * have to be on before anything much is printed. */
+	Interrupt_enableMaster();
+	runBootStage(BOOT_DDS, initializeDDS);
+	runBootStage(BOOT_I2C, initializeI2C);
+	runBootStage(BOOT_CALIBRATION, initializeCalStore);
+
+	waitStart = timerTicks();
+	while(!timerElapsed(powerUpStart, microsecondsToTicks(VERSACLOCK_POWER_UP_US)));
+	bootMicroseconds[BOOT_VERSACLOCK_WAIT] = ticksToMicroseconds(timerTicks() - waitStart);
+
+	if(bootFailures & (1 << BOOT_I2C))
+		bootFailures |= 1 << BOOT_VERSACLOCK_REGS;
+	else
+		runBootStage(BOOT_VERSACLOCK_REGS, writeVersaclockRegs);
+
+	setDDSFrequency(1000000); // Test the DDS out.
+	bootTotalMicroseconds = ticksToMicroseconds(timerTicks() - bootStart);
+	printBootReport();
+}
+
+/*
+ * One line, times in microseconds, for example
+ * "Boot Total 10950 Failures 0 Uart 210 Adc 95 ..."
+ */
+void printBootReport(void)
+{
+	int i;
+
+	printf("Boot Total %n Failures %x", bootTotalMicroseconds, bootFailures);
+	for(i = 0; i < NUM_BOOT_STAGES; i++)
+		printf(" %s %n", bootStageNames[i], bootMicroseconds[i]);
+	printf("\r\n");
+}
@@ -0,0 +1,40 @@
+/*
+ * boot.h
+ *
+ * Power-up sequencing.  bootInstrument() brings the peripherals up in
+ * dependency order, overlaps whatever it can with the VersaClock
+ * power-up wait, times every stage with the Timer32 time base and prints
+ * the breakdown.  A stage that still fails after BOOT_RETRIES attempts is
+ * recorded in bootFailures and the boot carries on without it.
+ */
+
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BOOT_RETRIES			3
+#define BOOT_RETRY_US			100
+#define VERSACLOCK_POWER_UP_US	10000	/* Datasheet minimum before I2C. */
+
+typedef enum {
+	BOOT_UART,
+	BOOT_ADC,
+	BOOT_VERSACLOCK_POWER,
+	BOOT_DDS,
+	BOOT_I2C,
+	BOOT_CALIBRATION,
+	BOOT_VERSACLOCK_WAIT,	/* What is left of the power-up wait. */
+	BOOT_VERSACLOCK_REGS,
+	NUM_BOOT_STAGES
+} BootStage;
+
+extern uint32_t bootMicroseconds[NUM_BOOT_STAGES];
+extern uint32_t bootTotalMicroseconds;
+extern uint16_t bootFailures;	/* Bit n set if BootStage n failed. */
+
+void bootInstrument(void);
+void printBootReport(void);
+
+#endif /* BOOT_H_ */
@@ -0,0 +1,196 @@
+/*
+ * busModel.c
+ *
+ * See busModel.h.  Times are kept in nanoseconds.  The model assumes a
+ * continuous run, so the first point of the sweep pays for moving the DDS
+ * and VersaClock back from the last point of the previous sweep.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "busModel.h"
+
+#define NS_PER_SECOND 1000000000ULL
+
+static const char *stageNames[NUM_BUS_STAGES] = {
+	"Dds", "Versaclock", "Settle", "Adc", "Output", "Uart"
+};
+
+const char *busStageName(BusStage stage)
+{
+	return stage < NUM_BUS_STAGES ? stageNames[stage] : "?";
+}
+
+/*
+ * The shipped bus settings (3 MHz SMCLK, 500 kHz SPI, 100 kHz I2C,
+ * 115200 baud) and first guesses at the CPU costs.
+ */
+void defaultBusConfig(BusConfig *config)
+{
+	config->cpuHz = 3000000;
+	config->spiHz = 500000;
+	config->i2cHz = 100000;
+	config->uartBaud = 115200;
+	config->adcHz = 3000000;
+	config->adcSampleClocks = 4;
+	config->adcConvertClocks = 16;
+	config->adcChannels = 4;
+	config->ddsBytes = 5;
+	config->versaclockBlocks = 3;
+	config->versaclockBlockBytes = 1;
+	config->versaclockVerifyBytes = 0;
+	config->ddsCpuCycles = 1500;
+	config->versaclockCpuCycles = 800;
+	config->adcCpuCycles = 150;
+	config->pointCpuCycles = 200;
+	config->outputCpuCyclesPerByte[0] = 60;	/* OUTPUT_ASCII, through printf */
+	config->outputCpuCyclesPerByte[1] = 12;	/* OUTPUT_BINARY */
+	config->outputCpuCyclesPerByte[2] = 20;	/* OUTPUT_TOUCHSTONE, by hand */
+	config->ddsSettleNs = 300000;
+	config->pllSettleNs = 0;
+	config->txQueueBytes = 2047;
+	config->bandOf = 0;
+}
+
+static uint64_t cyclesToNs(const BusConfig *config, uint64_t cycles)
+{
+	return cycles * NS_PER_SECOND / config->cpuHz;
+}
+
+static uint64_t bitsToNs(uint64_t bits, uint32_t hz)
+{
+	return hz ? bits * NS_PER_SECOND / hz : 0;
+}
+
+void predictSweep(const BusConfig *config, const SweepModel *sweep,
+		BusPrediction *prediction)
+{
+	/* One I2C block: start, address, register, data with an ACK bit after
+	 * every byte, then stop. */
+	uint64_t i2cBlockNs = bitsToNs(1 + 9 * (2 + config->versaclockBlockBytes) + 1,
+			config->i2cHz);
+	/* Readback: start, address, register, repeated start, address, data,
+	 * stop. */
+	uint64_t i2cVerifyNs = config->versaclockVerifyBytes ? bitsToNs(2 + 9
+			* (3 + config->versaclockVerifyBytes) + 1, config->i2cHz) : 0;
+	uint64_t ddsNs = bitsToNs(8 * config->ddsBytes, config->spiHz)
+			+ cyclesToNs(config, config->ddsCpuCycles);
+	uint64_t versaclockNs = config->versaclockBlocks * (i2cBlockNs + i2cVerifyNs
+			+ cyclesToNs(config, config->versaclockCpuCycles));
+	uint64_t adcNs = (uint64_t)config->adcChannels * (config->adcSampleClocks
+			+ config->adcConvertClocks) * NS_PER_SECOND / config->adcHz
+			+ cyclesToNs(config, config->adcCpuCycles);
+	uint64_t outputNs = cyclesToNs(config, config->pointCpuCycles
+			+ (uint64_t)config->outputCpuCyclesPerByte[sweep->outputFormat % BUS_NUM_OUTPUT_FORMATS]
+			* sweep->bytesPerPoint);
+	uint64_t byteNs = bitsToNs(10, config->uartBaud); /* 8N1 */
+	uint64_t pointUartNs = byteNs * sweep->bytesPerPoint;
+	uint64_t now = 0, uartIdleAt = 0, backlogNs, roomNs, cpuNs, stageNs;
+	long int frequency, lastFrequency;
+	int band, lastBand;
+	bool frequencyChanged, bandChanged, truncated = false;
+	uint16_t index, s;
+	BusStage stage;
+
+	for(s = 0; s < NUM_BUS_STAGES; s++)
+		prediction->stageNs[s] = 0;
+	prediction->stallNs = 0;
+	prediction->pointsDropped = 0;
+	prediction->bandChanges = 0;
+
+	if(sweep->numPoints == 0)
+	{
+		prediction->sweepNs = 0;
+		prediction->pointsPerSecond = 0;
+		prediction->bottleneck = STAGE_UART;
+		return;
+	}
+
+	lastFrequency = sweep->frequencyOf(sweep->numPoints - 1);
+	lastBand = config->bandOf ? config->bandOf(lastFrequency) : 0;
+
+	for(index = 0; index < sweep->numPoints; index++)
+	{
+		frequency = sweep->frequencyOf(index);
+		band = config->bandOf ? config->bandOf(frequency) : 0;
+		frequencyChanged = (frequency != lastFrequency) | (sweep->numPoints == 1);
+		bandChanged = (band != lastBand);
+		if(bandChanged)
+			prediction->bandChanges++;
+
+		for(s = 0; s < sweep->numStages; s++)
+		{
+			stage = sweep->stageOrder[s];
+			stageNs = 0;
+			switch(stage)
+			{
+			case STAGE_DDS:
+				if(frequencyChanged)
+					stageNs = ddsNs;
+				break;
+			case STAGE_VERSACLOCK:
+				if(bandChanged)
+					stageNs = versaclockNs;
+				break;
+			case STAGE_SETTLE:
+				if(frequencyChanged)
+					stageNs = config->ddsSettleNs;
+				if(bandChanged)
+					stageNs += config->pllSettleNs;
+				break;
+			case STAGE_ADC:
+				stageNs = adcNs;
+				break;
+			case STAGE_OUTPUT:
+				stageNs = outputNs;
+				now += stageNs;
+				/* Hand the point to the UART.  If the queue cannot take
+				 * it, either wait for room or drop it. */
+				backlogNs = uartIdleAt > now ? uartIdleAt - now : 0;
+				roomNs = byteNs * config->txQueueBytes;
+				if(truncated | (backlogNs + pointUartNs > roomNs))
+				{
+					/* stream.c drops the rest of a sweep after the first
+					 * point that does not fit. */
+					if(!sweep->blocking)
+					{
+						truncated = true;
+						prediction->pointsDropped++;
+						prediction->stageNs[stage] += stageNs;
+						continue;
+					}
+					prediction->stallNs += backlogNs + pointUartNs - roomNs;
+					now += backlogNs + pointUartNs - roomNs;
+				}
+				uartIdleAt = (uartIdleAt > now ? uartIdleAt : now) + pointUartNs;
+				prediction->stageNs[STAGE_UART] += pointUartNs;
+				prediction->stageNs[stage] += stageNs;
+				continue;
+			default:
+				break;
+			}
+			prediction->stageNs[stage] += stageNs;
+			now += stageNs;
+		}
+		lastFrequency = frequency;
+		lastBand = band;
+	}
+
+	prediction->sweepNs = uartIdleAt > now ? uartIdleAt : now;
+	prediction->pointsPerSecond = prediction->sweepNs ? (uint32_t)(sweep->numPoints
+			* NS_PER_SECOND / prediction->sweepNs) : 0;
+
+	/* The link is the bottleneck if it is busy for longer than the CPU;
+	 * otherwise it is whichever CPU stage costs the most. */
+	cpuNs = now - prediction->stallNs;
+	prediction->bottleneck = STAGE_UART;
+	if(cpuNs > prediction->stageNs[STAGE_UART])
+	{
+		prediction->bottleneck = STAGE_DDS;
+		for(s = STAGE_DDS; s < STAGE_UART; s++)
+			if(prediction->stageNs[s] > prediction->stageNs[prediction->bottleneck])
+				prediction->bottleneck = (BusStage)s;
+	}
+}
@@ -0,0 +1,84 @@
+/*
+ * busModel.h
+ *
+ * Timing model of one sweep.  The CPU runs the sweep stages in order
+ * while the UART drains the transmit queue in parallel; predictSweep()
+ * steps through every point of a plan, tracking when each stage ends and
+ * when the UART will next be idle, and reports points per second and the
+ * stage that limits them.
+ *
+ * Nothing here touches hardware, so busModel.c builds on a PC too.  On the
+ * MSP432, initializeBusConfig() in main.c fills BusConfig from the real
+ * spiMasterConfig, i2cConfig and uartConfig and the current clocks.  The
+ * CPU cost fields are estimates; compare the 'P' command's prediction with
+ * its tracepoint measurements and adjust them.
+ */
+
+#ifndef BUSMODEL_H_
+#define BUSMODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+	STAGE_DDS,			/* Tuning word to the AD9851 over SPI. */
+	STAGE_VERSACLOCK,	/* Band registers over I2C, only on a band change. */
+	STAGE_SETTLE,		/* DDS and PLL settling after a frequency change. */
+	STAGE_ADC,			/* One pass through the four ADC14 channels. */
+	STAGE_OUTPUT,		/* CPU time formatting and queueing the point. */
+	STAGE_UART,			/* Time on the wire; overlaps the other stages. */
+	NUM_BUS_STAGES
+} BusStage;
+
+#define BUS_NUM_OUTPUT_FORMATS	3	/* Ascii, binary and Touchstone. */
+
+typedef struct BusConfig {
+	uint32_t cpuHz;				/* MCLK */
+	uint32_t spiHz;
+	uint32_t i2cHz;
+	uint32_t uartBaud;
+	uint32_t adcHz;
+	uint16_t adcSampleClocks;	/* Sample and hold, per channel. */
+	uint16_t adcConvertClocks;	/* Conversion, per channel. */
+	uint16_t adcChannels;
+	uint16_t ddsBytes;			/* Bytes per tuning word. */
+	uint16_t versaclockBlocks;	/* I2C writes per band change. */
+	uint16_t versaclockBlockBytes;
+	uint16_t versaclockVerifyBytes;	/* Read back per block, 0 if not verifying. */
+	uint32_t ddsCpuCycles;		/* Tuning word arithmetic and SPI polling. */
+	uint32_t versaclockCpuCycles;	/* Per block, including the gap loop. */
+	uint32_t adcCpuCycles;		/* Trigger, ISR and copy out. */
+	uint32_t pointCpuCycles;	/* Everything else in serviceSweep(). */
+	uint32_t outputCpuCyclesPerByte[BUS_NUM_OUTPUT_FORMATS];	/* Indexed by OutputFormat. */
+	uint32_t ddsSettleNs;
+	uint32_t pllSettleNs;
+	uint16_t txQueueBytes;
+	int (*bandOf)(long int frequency);
+} BusConfig;
+
+typedef struct SweepModel {
+	uint16_t numPoints;
+	long int (*frequencyOf)(uint16_t index);
+	const BusStage *stageOrder;	/* As the firmware runs them. */
+	uint16_t numStages;
+	int outputFormat;			/* OutputFormat */
+	uint16_t bytesPerPoint;
+	bool blocking;				/* false when flow control drops instead. */
+} SweepModel;
+
+typedef struct BusPrediction {
+	uint64_t stageNs[NUM_BUS_STAGES];	/* Total over the sweep. */
+	uint64_t stallNs;			/* CPU waiting on a full queue. */
+	uint64_t sweepNs;			/* Until the last byte is on the wire. */
+	uint32_t pointsPerSecond;
+	uint32_t pointsDropped;
+	uint32_t bandChanges;
+	BusStage bottleneck;
+} BusPrediction;
+
+void defaultBusConfig(BusConfig *config);
+void predictSweep(const BusConfig *config, const SweepModel *sweep,
+		BusPrediction *prediction);
+const char *busStageName(BusStage stage);
+
+#endif /* BUSMODEL_H_ */
@@ -0,0 +1,211 @@
+/*
+ * calStore.c
+ *
+ * See calStore.h for the page layout and how the two pages are used.
+ */
+
+/* DriverLib Includes */
+#include "driverlib.h"
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "sweep.h"
+#include "calStore.h"
+
+#define CAL_CRC_SEED	0xFFFFFFFF
+
+/* Bytes from magic up to where the CRC starts. */
+#define CAL_HEADER_BYTES	offsetof(CalPage, sequence)
+
+const CalPage *activeCal;
+
+static const CalPage * const calPages[CAL_NUM_PAGES] = {
+	(const CalPage *)CAL_PAGE0_ADDRESS, (const CalPage *)CAL_PAGE1_ADDRESS
+};
+static const uint32_t calSectors[CAL_NUM_PAGES] = {FLASH_SECTOR0, FLASH_SECTOR1};
+static int activePage = -1;
+static CalPage calEdit;
+static bool editing;
+
+static uint16_t calLength(uint16_t solPoints)
+{
+	return offsetof(CalPage, sol) - CAL_HEADER_BYTES + solPoints * sizeof(CalTerms);
+}
+
+/* CRC-32 on the hardware CRC module, 16 bits at a time. */
+static uint32_t calCrc(const CalPage *page)
+{
+	const uint16_t *p = (const uint16_t *)&page->sequence;
+	uint16_t n = page->length / 2;
+
+	MAP_CRC32_setSeed(CAL_CRC_SEED, CRC32_MODE);
+	while(n--)
+		MAP_CRC32_set16BitData(*p++, CRC32_MODE);
+	return MAP_CRC32_getResult(CRC32_MODE);
+}
+
+/* Everything but the CRC, which is the slow part. */
+static bool calHeaderValid(const CalPage *page)
+{
+	return (page->magic == CAL_MAGIC) & (page->version == CAL_VERSION) &
+			(page->solPoints <= CAL_MAX_SOL_POINTS) &&
+			(page->length == calLength(page->solPoints));
+}
+
+/*
+ * Find the live page.  Only the newer page's CRC is normally checked;
+ * the older one is only looked at if that fails.  Having no calibration
+ * is not an error, the instrument just measures uncorrected.
+ */
+int initializeCalStore(void)
+{
+	int newer = 0, i, page;
+
+	activeCal = 0;
+	activePage = -1;
+	if(calHeaderValid(calPages[1]) && (!calHeaderValid(calPages[0]) ||
+			(calPages[1]->sequence > calPages[0]->sequence)))
+		newer = 1;
+
+	for(i = 0; i < CAL_NUM_PAGES; i++)
+	{
+		page = (newer + i) % CAL_NUM_PAGES;
+		if(calHeaderValid(calPages[page]) && (calCrc(calPages[page]) == calPages[page]->crc))
+		{
+			activeCal = calPages[page];
+			activePage = page;
+			break;
+		}
+	}
+	return 1;
+}
+
+/*
+ * The RAM working copy, started from the live calibration the first time
+ * it is asked for.
+ */
+CalPage *calEditPage(void)
+{
+	if(!editing)
+	{
+		if(activeCal)
+			memcpy(&calEdit, activeCal, CAL_HEADER_BYTES + activeCal->length);
+		else
+			calClearEdit();
+		editing = true;
+	}
+	return &calEdit;
+}
+
+void calClearEdit(void)
+{
+	int band, r;
+
+	memset(&calEdit, 0, sizeof(calEdit));
+	for(band = 0; band < NUM_BANDS; band++)
+		for(r = 0; r < CAL_NUM_RECEIVERS; r++)
+			calEdit.iq[band][r].gain = CAL_IQ_UNITY_GAIN;
+	editing = true;
+}
+
+/*
+ * Write the working copy to the page that is not live and switch to it.
+ * A working copy that matches the live page is not written, to save an
+ * erase cycle.  Returns false if the new page does not read back valid,
+ * in which case the old calibration stays live.
+ */
+bool calSave(void)
+{
+	int page = (activePage == 0) ? 1 : 0;
+	uint32_t bytes;
+	bool written;
+
+	if(!editing)
+		return true;
+	calEdit.magic = CAL_MAGIC;
+	calEdit.version = CAL_VERSION;
+	calEdit.length = calLength(calEdit.solPoints);
+	calEdit.sequence = activeCal ? activeCal->sequence + 1 : 1;
+	calEdit.crc = calCrc(&calEdit);
+	bytes = CAL_HEADER_BYTES + calEdit.length;
+
+	if(activeCal && (activeCal->length == calEdit.length) &&
+			(memcmp(&activeCal->flags, &calEdit.flags, bytes - offsetof(CalPage, flags)) == 0))
+	{
+		editing = false;
+		return true;
+	}
+
+	MAP_FlashCtl_unprotectSector(FLASH_INFO_MEMORY_SPACE_BANK1, calSectors[page]);
+	written = MAP_FlashCtl_eraseSector((uint32_t)calPages[page]) &&
+			MAP_FlashCtl_programMemory(&calEdit, (void *)calPages[page], bytes);
+	MAP_FlashCtl_protectSector(FLASH_INFO_MEMORY_SPACE_BANK1, calSectors[page]);
+
+	if(!written || !calHeaderValid(calPages[page]) ||
+			(calCrc(calPages[page]) != calPages[page]->crc))
+		return false;
+	activeCal = calPages[page];
+	activePage = page;
+	editing = false;
+	return true;
+}
+
+/* Settle time after retuning into band, from the table if there is one. */
+uint16_t calSettleMicroseconds(int band)
+{
+	if((activeCal == 0) || !(activeCal->flags & CAL_HAS_SETTLE) ||
+			(band < 0) || (activeCal->settleMicroseconds[band] == 0))
+		return SWEEP_SETTLE_US;
+	return activeCal->settleMicroseconds[band];
+}
+
+static uint16_t clampADC(int32_t value)
+{
+	if(value < 0)
+		return 0;
+	if(value > ADC_FULL_SCALE)
+		return ADC_FULL_SCALE;
+	return (uint16_t)value;
+}
+
+/*
+ * Apply the quadrature correction for band to one set of ADC results, in
+ * place.  The results stay in ADC counts so the output format does not
+ * change.
+ */
+#pragma CODE_SECTION(calCorrectIQ, ".sramcode")
+void calCorrectIQ(int band, uint16_t *results)
+{
+	const IQCorrection *iq;
+	int32_t i, q;
+	int r;
+
+	if((activeCal == 0) || !(activeCal->flags & CAL_HAS_IQ) || (band < 0))
+		return;
+	for(r = 0; r < CAL_NUM_RECEIVERS; r++)
+	{
+		iq = &activeCal->iq[band][r];
+		if(iq->gain == 0)
+			continue;
+		i = (int32_t)results[2 * r] - ADC_MIDSCALE - iq->offsetI;
+		q = (int32_t)results[2 * r + 1] - ADC_MIDSCALE - iq->offsetQ;
+		q = ((q * iq->gain) >> 14) - ((i * iq->phase) >> 15);
+		results[2 * r] = clampADC(i + ADC_MIDSCALE);
+		results[2 * r + 1] = clampADC(q + ADC_MIDSCALE);
+	}
+}
+
+void printCalStatus(void)
+{
+	printf("Cal Page %d", activePage);
+	if(activeCal)
+		printf(" Seq %n Flags %x SolPoints %d", activeCal->sequence, activeCal->flags,
+				activeCal->solPoints);
+	printf(" Editing %d\r\n", editing);
+}
@@ -0,0 +1,94 @@
+/*
+ * calStore.h
+ *
+ * Calibration store in INFO flash bank 1.  Its two 4 KB sectors hold two
+ * copies of a CalPage; a save always erases and programs the sector that
+ * is not live, with the sequence number one higher, so a power cut part
+ * way through leaves the previous calibration in place.  At boot the
+ * newest page whose magic, version, length and CRC-32 check out is used
+ * where it sits in flash through activeCal; nothing is copied to RAM.
+ *
+ * Bank 1 of INFO is where TI ships the BSL.  This board is programmed
+ * through the debugger, so the BSL is given up for the store.
+ *
+ * Changes are made to a RAM working copy (calEditPage()) and take effect
+ * when calSave() writes it out.
+ */
+
+#ifndef CALSTORE_H_
+#define CALSTORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "vna.h"
+
+#define CAL_PAGE0_ADDRESS	0x00202000
+#define CAL_PAGE1_ADDRESS	0x00203000
+#define CAL_PAGE_BYTES		4096
+#define CAL_NUM_PAGES		2
+
+#define CAL_MAGIC			0x43414E56	/* "VNAC" */
+#define CAL_VERSION			1
+
+#define CAL_NUM_RECEIVERS	2			/* S11 on ADC 0/1, S21 on ADC 2/3. */
+#define CAL_MAX_SOL_POINTS	320			/* What fits in a page. */
+
+/* CalPage.flags */
+#define CAL_HAS_IQ			0x0001
+#define CAL_HAS_SETTLE		0x0002
+#define CAL_HAS_SOL			0x0004
+
+#define CAL_IQ_UNITY_GAIN	16384		/* Q14 one, no correction. */
+
+/* Quadrature correction for one receiver in one VersaClock band:
+ * I' = I - offsetI, Q' = gain * (Q - offsetQ) - phase * I', with I and Q
+ * taken about ADC_MIDSCALE.  A cleared page starts every entry at unity
+ * gain; an entry with a gain of 0 was never set and is skipped. */
+typedef struct IQCorrection {
+	int16_t offsetI;		/* ADC counts */
+	int16_t offsetQ;		/* ADC counts */
+	int16_t gain;			/* Q14 */
+	int16_t phase;			/* Q15, sine of the quadrature error. */
+} IQCorrection;
+
+typedef struct CalComplex {
+	int16_t re;
+	int16_t im;
+} CalComplex;
+
+/* One-port error terms at one calibration frequency.  Directivity and
+ * tracking are in ADC counts about ADC_MIDSCALE, source match in Q15. */
+typedef struct CalTerms {
+	CalComplex directivity;	/* e00 */
+	CalComplex sourceMatch;	/* e11 */
+	CalComplex tracking;	/* e10e01 */
+} CalTerms;
+
+/* Every field is naturally aligned, so the layout is packed as is. */
+typedef struct CalPage {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t length;		/* Bytes from sequence to the last SOL point. */
+	uint32_t crc;			/* CRC-32 of those bytes. */
+	uint32_t sequence;		/* The higher valid page is the live one. */
+	uint16_t flags;
+	uint16_t solPoints;
+	int32_t solStartFrequency;	/* Hz, SOL points are linearly spaced. */
+	int32_t solStopFrequency;
+	uint16_t settleMicroseconds[NUM_BANDS];	/* 0 = SWEEP_SETTLE_US */
+	IQCorrection iq[NUM_BANDS][CAL_NUM_RECEIVERS];
+	CalTerms sol[CAL_MAX_SOL_POINTS];
+} CalPage;
+
+extern const CalPage *activeCal;	/* 0 if neither page is valid. */
+
+int initializeCalStore(void);
+CalPage *calEditPage(void);
+void calClearEdit(void);
+bool calSave(void);
+uint16_t calSettleMicroseconds(int band);
+void calCorrectIQ(int band, uint16_t *results);
+void printCalStatus(void);
+
+#endif /* CALSTORE_H_ */
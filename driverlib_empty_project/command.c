@@ -0,0 +1,389 @@
+/*
+ * command.c
+ *
+ * Collects bytes from the UART receive queue into lines and runs them.
+ * See command.h for the command set.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "busModel.h"
+#include "uartQueue.h"
+#include "stream.h"
+#include "sweep.h"
+#include "trace.h"
+#include "benchmark.h"
+#include "calStore.h"
+#include "sol.h"
+#include "sweepStore.h"
+#include "average.h"
+#include "limitMask.h"
+#include "trigger.h"
+#include "tdr.h"
+#include "dutModel.h"
+#include "adaptive.h"
+#include "command.h"
+
+static char line[COMMAND_MAX_LENGTH];
+static uint8_t lineLength;
+static bool lineOverflow;
+static uint8_t traceBuffer[TRACE_REPORT_BYTES + STREAM_CRC_BYTES];
+
+/*
+ * Parse up to maxArgs signed decimal numbers.  Returns the number found,
+ * or -1 if something other than a number or separator turns up.
+ */
+static int parseArguments(const char *s, long int *args, int maxArgs)
+{
+	int numArgs = 0;
+	bool negative;
+	long int value;
+
+	while(1)
+	{
+		while((*s == ' ') | (*s == ',') | (*s == '\t'))
+			s++;
+		if(*s == 0)
+			return numArgs;
+		if(numArgs == maxArgs)
+			return -1;
+
+		negative = (*s == '-');
+		if(negative)
+			s++;
+		if((*s < '0') | (*s > '9'))
+			return -1;
+		for(value = 0; (*s >= '0') & (*s <= '9'); s++)
+			value = value * 10 + (*s - '0');
+		args[numArgs++] = negative ? -value : value;
+	}
+}
+
+/* Tracepoint that measures each modelled stage, or -1 if none does. */
+static const int stageTracepoint[NUM_BUS_STAGES] = {
+	TRACE_SET_DDS_FREQUENCY, TRACE_UPDATE_VERSACLOCK_REGS, -1,
+	TRACE_ADC_CONVERSION, TRACE_STREAM_POINT, -1
+};
+
+static const uint16_t streamPointBytes[NUM_OUTPUT_FORMATS] = {
+	STREAM_ASCII_POINT_BYTES, STREAM_BINARY_POINT_BYTES, STREAM_TOUCHSTONE_POINT_BYTES
+};
+
+/*
+ * Print the bus model's prediction for the current plan next to what the
+ * tracepoints have measured since they were last cleared, both in ns per
+ * point.  Clear with "T 0", run some sweeps, then ask.
+ */
+static void reportPrediction(void)
+{
+	BusConfig config;
+	SweepModel model;
+	BusPrediction prediction;
+	TraceStats *points = &traceStats[TRACE_SWEEP_POINT];
+	uint64_t clockHz = traceClockHz();
+	int s;
+
+	initializeBusConfig(&config);
+	model.numPoints = sweepPlan.numPoints;
+	model.frequencyOf = sweepPointFrequency;
+	model.stageOrder = sweepStageOrder;
+	model.numStages = SWEEP_NUM_STAGES;
+	model.outputFormat = getOutputFormat();
+	model.bytesPerPoint = streamPointBytes[getOutputFormat()];
+	model.blocking = !streamFlowControl();
+	predictSweep(&config, &model, &prediction);
+
+	printf("Predict PointsPerSec %n Bottleneck %s", prediction.pointsPerSecond,
+			busStageName(prediction.bottleneck));
+	for(s = 0; s < NUM_BUS_STAGES; s++)
+		printf(" %s %n", busStageName((BusStage)s),
+				(uint32_t)(prediction.stageNs[s] / model.numPoints));
+	printf(" Stall %n\r\n", (uint32_t)(prediction.stallNs / model.numPoints));
+
+	printf("Measured PointsPerSec %n", points->count ? (uint32_t)(clockHz
+			* points->count / points->totalCycles) : 0);
+	for(s = 0; s < NUM_BUS_STAGES; s++)
+	{
+		if((stageTracepoint[s] < 0) | (points->count == 0))
+			continue;
+		printf(" %s %n", busStageName((BusStage)s), (uint32_t)(traceStats[
+				stageTracepoint[s]].totalCycles / points->count
+				* 1000000000ULL / clockHz));
+	}
+	printf("\r\n");
+}
+
+/* Whether args[first] on to args[numArgs - 1] all fit in an int16_t. */
+static bool int16Arguments(const long int *args, int first, int numArgs)
+{
+	int i;
+
+	for(i = first; i < numArgs; i++)
+		if((args[i] < -32768) || (args[i] > 32767))
+			return false;
+	return true;
+}
+
+static bool executeCommand(char command, const long int *args, int numArgs)
+{
+	CalPage *cal;
+
+	switch(command)
+	{
+	case 'F':
+		if(numArgs == 0)
+			sendFrequencyList();
+		else if(numArgs == 3)
+			return (args[2] >= 0) && (args[2] <= 0xFFFF) &&
+					setSweepPlan(args[0], args[1], (uint16_t)args[2]);
+		else if(numArgs == 4)
+			return (args[2] >= 0) && (args[2] <= 0xFFFF) && (args[3] >= 0) &&
+					(args[3] <= 0xFFFF) &&
+					setAdaptivePlan(args[0], args[1], (uint16_t)args[2], (uint16_t)args[3]);
+		else
+			return false;
+		return true;
+	case 'S':
+		startSweep(SWEEP_SINGLE);
+		return true;
+	case 'R':
+		startSweep(SWEEP_CONTINUOUS);
+		return true;
+	case 'H':
+		haltSweep();
+		return true;
+	case 'C':
+		if((numArgs != 1) || (args[0] < 0))
+			return false;
+		streamGrantCredits(args[0] > STREAM_MAX_CREDITS ? STREAM_MAX_CREDITS
+				: (uint16_t)args[0]);
+		return true;
+	case 'X':
+		streamDisableFlowControl();
+		return true;
+	case 'M':
+		if((numArgs != 1) || (args[0] < OUTPUT_ASCII) || (args[0] > OUTPUT_TOUCHSTONE))
+			return false;
+		setOutputFormat((OutputFormat)args[0]);
+		return true;
+	case 'V':
+		if((numArgs != 1) || (args[0] < 0) || (args[0] > 1))
+			return false;
+		setVersaclockVerify(args[0]);
+		return true;
+	case 'Q':
+		if((numArgs != 6) || (args[0] < 0) || (args[0] >= NUM_BANDS) ||
+				(args[1] < 0) || (args[1] >= CAL_NUM_RECEIVERS) ||
+				!int16Arguments(args, 2, numArgs))
+			return false;
+		cal = calEditPage();
+		cal->iq[args[0]][args[1]].offsetI = (int16_t)args[2];
+		cal->iq[args[0]][args[1]].offsetQ = (int16_t)args[3];
+		cal->iq[args[0]][args[1]].gain = (int16_t)args[4];
+		cal->iq[args[0]][args[1]].phase = (int16_t)args[5];
+		cal->flags |= CAL_HAS_IQ;
+		return true;
+	case 'W':
+		if((numArgs != 2) || (args[0] < 0) || (args[0] >= NUM_BANDS) ||
+				(args[1] < 0) || (args[1] > 0xFFFF))
+			return false;
+		cal = calEditPage();
+		cal->settleMicroseconds[args[0]] = (uint16_t)args[1];
+		cal->flags |= CAL_HAS_SETTLE;
+		return true;
+	case 'K':
+		if(numArgs == 0)
+			printCalStatus();
+		else if((numArgs == 1) && (args[0] == 0))
+			calClearEdit();
+		else if((numArgs == 1) && (args[0] == 1))
+			return calSave();
+		else
+			return false;
+		return true;
+	case 'L':
+		if(numArgs == 0)
+			printSolStatus();
+		else if((numArgs == 1) && (args[0] == SOL_NUM_STANDARDS))
+			return solComputeTerms();
+		else if(numArgs == 1)
+			return solArmCapture(args[0]);
+		else
+			return false;
+		return true;
+	case 'E':
+		if((numArgs != 1) || (args[0] < 0) || (args[0] > 1))
+			return false;
+		solSetCorrection(args[0]);
+		return true;
+	case 'I':
+		if((numArgs != 1) || (args[0] < SOL_LINEAR) || (args[0] > SOL_CUBIC))
+			return false;
+		solSetInterpolation((SolInterpolation)args[0]);
+		return true;
+	case 'G':
+		if(numArgs == 0)
+			printStoreStatus();
+		else if((numArgs == 1) && (args[0] == 0))
+			storeStop();
+		else if(((numArgs == 1) || ((numArgs == 2) && (args[1] >= 0) &&
+				(args[1] <= (STORE_RING | STORE_RAW)))) && (args[0] > 0) && (args[0] <= 0xFFFF))
+			return storeArm((uint16_t)args[0], (numArgs == 2) ? (uint8_t)args[1] : 0);
+		else
+			return false;
+		return true;
+	case 'Y':
+		if(numArgs == 0)
+			storeSendBurst();
+		else if(numArgs == 1)
+			return storeSendSweep((uint32_t)args[0]);
+		else if((numArgs == 2) && (args[1] == 1))
+			return storeSendFrom((uint32_t)args[0]);
+		else
+			return false;
+		return true;
+	case 'Z':
+		if((numArgs != 1) || (args[0] < 0) || (args[0] > 0xFFFF))
+			return false;
+		return storeSendPoint((uint16_t)args[0]);
+	case 'A':
+		if(numArgs == 0)
+			averageRequestSend();
+		else if((numArgs == 1) && (args[0] == AVERAGE_OFF))
+			setAveraging(AVERAGE_OFF, 0, 0);
+		else if((numArgs == 3) && (args[0] == AVERAGE_EXPONENTIAL) &&
+				(args[1] >= 0) && (args[1] <= 0xFFFF) &&
+				(args[2] >= 0) && (args[2] <= 0xFFFF))
+			return setAveraging(AVERAGE_EXPONENTIAL, (uint16_t)args[1], (uint16_t)args[2]);
+		else if((numArgs == 2) && (args[0] == AVERAGE_BLOCK) &&
+				(args[1] > 0) && (args[1] <= 0xFFFF))
+			return setAveraging(AVERAGE_BLOCK, (uint16_t)args[1], 0);
+		else
+			return false;
+		return true;
+	case 'D':
+		if((numArgs == 1) && (args[0] == 0))
+			setChangeDetection(false, 0, 0);
+		else if((numArgs == 3) && (args[0] == 1) && (args[1] >= 0) && (args[1] <= 0xFFFF)
+				&& (args[2] >= 0) && (args[2] <= 0xFFFF))
+			setChangeDetection(true, (uint16_t)args[1], (uint16_t)args[2]);
+		else
+			return false;
+		return true;
+	case 'U':
+		if(numArgs == 0)
+			clearLimits();
+		else if((numArgs == 5) && ((args[0] == LIMIT_S11) || (args[0] == LIMIT_S21)) &&
+				(args[3] >= 0) && (args[3] <= 0xFFFF) && (args[4] >= 0) && (args[4] <= 0xFFFF))
+			return addLimitSegment((LimitParameter)args[0], args[1], args[2],
+					(uint16_t)args[3], (uint16_t)args[4]);
+		else
+			return false;
+		return true;
+	case 'J':
+		if((numArgs != 1) || (args[0] < LIMIT_OFF) || (args[0] > LIMIT_TEST_ABORT))
+			return false;
+		setLimitMode((LimitMode)args[0]);
+		return true;
+	case 'O':
+		if(numArgs == 0)
+			printTdrStatus();
+		else if((numArgs == 1) && (args[0] == TDR_OFF))
+			setTdr(TDR_OFF, TDR_HANN);
+		else if((numArgs == 2) && (args[0] >= TDR_BANDPASS) && (args[0] <= TDR_LOWPASS) &&
+				(args[1] >= TDR_RECTANGULAR) && (args[1] <= TDR_BLACKMAN))
+			setTdr((TdrMode)args[0], (TdrWindow)args[1]);
+		else
+			return false;
+		return true;
+	case 'N':
+		if(numArgs == 0)
+			printTriggerStatus();
+		else if((numArgs == 1) && (args[0] >= TRIGGER_FREE) && (args[0] <= TRIGGER_LEAD))
+			setTriggerMode((TriggerMode)args[0]);
+		else
+			return false;
+		return true;
+	case '?':
+		printStreamStatus();
+		printI2CStatus();
+		return true;
+	case 'B':
+		if(numArgs == 0)
+			runBenchmarks();
+		else if((numArgs >= 2) && (numArgs <= 3) && (args[0] == 1) &&
+				(args[1] >= 1) && (args[1] <= 0xFFFF))
+			return runReplay((uint16_t)args[1], (numArgs == 3) && (args[2] != 0));
+#ifdef DUT_MODEL
+		else if((numArgs == 1) && (args[0] == 2))
+			printDutModelStatus();
+		else if((numArgs >= 2) && (numArgs <= 3) && (args[0] == 2) &&
+				(args[1] >= 0) && (args[1] < NUM_DUTS) &&
+				((numArgs == 2) || ((args[2] >= 0) && (args[2] <= 0xFFFF))))
+			return dutModelSelect((DutType)args[1],
+					(numArgs == 3) ? (uint16_t)args[2] : DUT_DEFAULT_NOISE);
+#endif
+		else
+			return false;
+		return true;
+	case 'P':
+		reportPrediction();
+		return true;
+	case 'T':
+		if(numArgs == 0)
+			streamWriteFrame(traceBuffer, traceReport(traceBuffer, TRACE_REPORT_BYTES));
+		else if((numArgs == 1) && (args[0] == 0))
+			clearTrace();
+		else
+			return false;
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void runLine(void)
+{
+	long int args[COMMAND_MAX_ARGS];
+	int numArgs;
+	char command = line[0];
+
+	line[lineLength] = 0;
+	if((command >= 'a') & (command <= 'z'))
+		command -= 'a' - 'A';
+
+	numArgs = parseArguments(&line[1], args, COMMAND_MAX_ARGS);
+	if(lineOverflow | (numArgs < 0) || !executeCommand(command, args, numArgs))
+		printf("ERR %c\r\n", command);
+}
+
+/*
+ * Run any complete command lines waiting in the receive queue.  Called
+ * from the main loop between sweep points.  Commands wait while a store
+ * read is going out, so nothing they print lands in the middle of it.
+ */
+void serviceCommands(void)
+{
+	uint8_t c;
+
+	if(storeReading())
+		return;
+	while(uartQueueGet(&c))
+	{
+		if((c == '\r') | (c == '\n'))
+		{
+			if(lineLength != 0)
+				runLine();
+			lineLength = 0;
+			lineOverflow = false;
+		}
+		else if(lineLength < COMMAND_MAX_LENGTH - 1)
+			line[lineLength++] = c;
+		else
+			lineOverflow = true;
+	}
+}
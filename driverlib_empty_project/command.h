@@ -0,0 +1,94 @@
+/*
+ * command.h
+ *
+ * Line based command interface on the backchannel UART.  Each command is
+ * one letter followed by up to COMMAND_MAX_ARGS decimal arguments separated
+ * by spaces or commas, terminated by CR or LF.  Unknown or malformed
+ * commands are answered with "ERR <letter>".
+ *
+ *   F start stop points   Set the sweep plan (Hz, Hz, count).
+ *   F start stop c n      Adaptive plan: one sweep of c points, then n
+ *                         points concentrated where it changed most (see
+ *                         adaptive.h).
+ *   F                     Send the plan's frequencies (binary).
+ *   S                     Measure one sweep.
+ *   R                     Sweep continuously.
+ *   H                     Halt after the current point.
+ *   C n                   Grant n sweep credits (turns on flow control).
+ *   X                     Turn flow control off; output blocks again.
+ *   M n                   Output format, 0 = ASCII, 1 = binary,
+ *                         2 = Touchstone (see stream.h).
+ *   V n                   VersaClock readback after every write, 1 = on
+ *                         (the default), 0 = off.
+ *   Q band rx oi oq g p   Quadrature correction for receiver rx (0 = S11,
+ *                         1 = S21) in VersaClock band: offsets in ADC
+ *                         counts, gain Q14, phase Q15 (see calStore.h).
+ *   W band us             Settle time after retuning into band, 0 for the
+ *                         default.
+ *   K                     Print the calibration store status.
+ *   K 0                   Start the working calibration from empty.
+ *   K 1                   Save the working calibration to flash and use it.
+ *                         Q and W only change the working copy.
+ *   L n                   Capture calibration standard n (0 = short,
+ *                         1 = open, 2 = load) on the next sweep.
+ *   L 3                   Work out the one-port error terms from the three
+ *                         captures into the working calibration.
+ *   L                     Print the capture status.
+ *   E n                   S11 error correction, 1 = on (the default), 0 = off.
+ *   I n                   Error term interpolation, 0 = linear, 1 = cubic
+ *                         (the default).
+ *   G k                   Store the next k sweeps in RAM instead of sending
+ *                         them (see sweepStore.h).
+ *   G k 1                 Keep storing the last k sweeps until "G 0".
+ *   G k 2, G k 3          As G k and G k 1, storing raw ADC readings.
+ *   G                     Print the store status.
+ *   Y                     Send every stored sweep in one burst.
+ *   Y seq                 Send stored sweep number seq.
+ *   Y seq 1               Send every stored sweep from number seq on.
+ *   Z index               Send point index of every stored sweep.
+ *   A 0                   Averaging off.
+ *   A 1 k e               Exponential averaging with weight 1/2^k, sent
+ *                         every e sweeps (0 = only on request).
+ *   A 2 n                 Block average of n sweeps, sent once per block.
+ *   A                     Send the exponential average with the next sweep.
+ *   D 0                   Change detection off.
+ *   D 1 t k               Send only points where a channel moved by more
+ *                         than t counts, with a keyframe every k sweeps
+ *                         (0 = only when needed).  Binary output only.
+ *   U p f1 f2 lo hi       Add a limit mask segment: |S11| (p = 0) or |S21|
+ *                         (p = 1) from f1 to f2 Hz must lie within lo and
+ *                         hi, 0 for no limit (see limitMask.h).
+ *   U                     Clear the limit mask.
+ *   J n                   Limit testing, 0 = off, 1 = on, 2 = on and stop
+ *                         the sweep at the first failure.
+ *   O m w                 Time domain transform of S11 after every sweep,
+ *                         m = 1 band pass, 2 low pass, with window w,
+ *                         0 = rectangular, 1 = Hann, 2 = Blackman.  Binary
+ *                         output only (see tdr.h).
+ *   O 0                   Time domain transform off.
+ *   O                     Print the transform status.
+ *   N n                   Sweep trigger, 0 = free running, 1 = wait for
+ *                         the trigger line, 2 = drive it (see trigger.h).
+ *   N                     Print the device ID and trigger status.
+ *   ?                     Print the stream and I2C status counters.
+ *   B                     Run the sweep benchmarks (see benchmark.h).
+ *   B 1 n, B 1 n 1        Replay the raw recording n times, flat out or
+ *                         at the recorded pace (see benchmark.h).
+ *   B 2 d, B 2 d n        Built with DUT_MODEL, simulate DUT d with n ADC
+ *                         counts rms of noise (see dutModel.h).
+ *   B 2                   Built with DUT_MODEL, print the simulated DUT.
+ *   P                     Print the bus model's prediction for the current
+ *                         plan beside the tracepoint measurements.
+ *   T                     Send the tracepoint report (binary, see trace.c).
+ *   T 0                   Clear the tracepoint statistics.
+ */
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#define COMMAND_MAX_LENGTH	64
+#define COMMAND_MAX_ARGS	6
+
+void serviceCommands(void);
+
+#endif /* COMMAND_H_ */
@@ -0,0 +1,18 @@
+/*
+ * crc16.h
+ *
+ * CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF, no
+ * reflection, no final XOR) over binary frames.  Table driven, and plain
+ * C so the host can use the same file to check frames.
+ */
+
+#ifndef CRC16_H_
+#define CRC16_H_
+
+#include <stdint.h>
+
+#define CRC16_INIT	0xFFFF
+
+uint16_t crc16(uint16_t crc, const uint8_t *data, uint32_t numBytes);
+
+#endif /* CRC16_H_ */
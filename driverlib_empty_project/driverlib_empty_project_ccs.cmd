@@ -41,9 +41,14 @@
 MEMORY
 {
     MAIN       (RX) : origin = 0x00000000, length = 0x00040000
-    INFO       (RX) : origin = 0x00200000, length = 0x00004000
-    SRAM_CODE  (RWX): origin = 0x01000000, length = 0x00010000
-    SRAM_DATA  (RW) : origin = 0x20000000, length = 0x00010000
+    /* INFO bank 1 (0x00202000) is the calibration store, see calStore.h. */
+    INFO       (RX) : origin = 0x00200000, length = 0x00002000
+    CAL_INFO   (R)  : origin = 0x00202000, length = 0x00002000
+    /* SRAM_CODE (0x01000000) and SRAM_DATA (0x20000000) are two views of */
+    /* the same 64 KB of SRAM, so they must not overlap.  The top 8 KB is  */
+    /* for code that runs from SRAM; the rest is data and stack.           */
+    SRAM_CODE  (RWX): origin = 0x0100E000, length = 0x00002000
+    SRAM_DATA  (RW) : origin = 0x20000000, length = 0x0000E000
 }
 
 /* The following command line options are set as part of the CCS project.    */
@@ -64,11 +69,19 @@ MEMORY
 SECTIONS
 {
     .intvecs:   > 0x00000000
-    .text   :   > MAIN
-    .const  :   > MAIN
+    .text   :   > MAIN, SIZE(textSize)
+    .const  :   > MAIN, SIZE(constSize)
     .cinit  :   > MAIN
     .pinit  :   > MAIN
     .init_array  :   > MAIN
+    .ovly   :   > MAIN
+
+    /* Interrupt handlers and the sweep loop (#pragma CODE_SECTION         */
+    /* ".sramcode").  Stored in flash and copied to SRAM_CODE by resetISR  */
+    /* so they run with no flash wait states.  The sizes of these sections */
+    /* are printed at boot and listed in the .map file.                    */
+    .sramcode : LOAD = MAIN, RUN = SRAM_CODE, table(sramCodeCopyTable),
+                SIZE(sramCodeSize)
 
     .flashMailbox : > 0x00200000
 
@@ -0,0 +1,283 @@
+/*
+ * dutModel.c
+ *
+ * See dutModel.h.  The DUT is worked out as an ABCD matrix in single
+ * precision, which the M4F does in hardware, then turned into S11 and
+ * S21 between 50 ohm ports.  Nothing here touches hardware, so it also
+ * builds on a PC, for test/dutBench.c.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "dutModel.h"
+
+#define TWO_PI		6.2831853f
+#define Z0			50.0f
+#define NEPERS_PER_DB	0.11512925f
+
+/* The front end.  Directivity is a fraction of the tracking; the delays
+ * are one way, reference plane to the receiver. */
+#define FE_TRACKING			6000.0f		/* ADC counts for a full reflection. */
+#define FE_PATH_DELAY		1.5e-9f
+#define FE_DIRECTIVITY		0.02f
+#define FE_DIRECTIVITY_DELAY	0.5e-9f
+#define FE_SOURCE_MATCH		0.05f
+#define FE_MATCH_DELAY		3.0e-9f
+#define FE_TRANSMISSION		6000.0f		/* ADC counts for S21 = 1. */
+#define FE_CROSSTALK		10.0f		/* ADC counts */
+
+#define DUT_MAX_ELEMENTS	5
+#define DUT_MAX_NOISE		1000
+
+typedef enum {
+	ELEMENT_NONE = 0,
+	ELEMENT_SERIES,		/* RLC in line. */
+	ELEMENT_SHUNT,		/* RLC to ground. */
+	ELEMENT_LINE		/* Transmission line. */
+} ElementKind;
+
+typedef struct DutElement {
+	ElementKind kind;
+	float resistance;	/* ohms, or a line's characteristic impedance */
+	float inductance;	/* henries */
+	float capacitance;	/* farads, 0 for none */
+	float delay;		/* seconds, lines only */
+	float loss;			/* dB at 100 MHz going as root f, lines only */
+} DutElement;
+
+/* Quadrature imbalance and DC offset of one receiver, the inverse of what
+ * calCorrectIQ() takes out. */
+typedef struct ReceiverError {
+	float offsetI;		/* ADC counts */
+	float offsetQ;
+	float gain;			/* Of Q against I. */
+	float phase;		/* radians */
+} ReceiverError;
+
+typedef struct Complex {
+	float re;
+	float im;
+} Complex;
+
+static const DutElement duts[NUM_DUTS][DUT_MAX_ELEMENTS] = {
+	/* DUT_THRU */
+	{{ELEMENT_NONE, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}},
+	/* DUT_OPEN, with 1 fF of fringing */
+	{{ELEMENT_SERIES, 0.0f, 0.0f, 1e-15f, 0.0f, 0.0f}},
+	/* DUT_SHORT, with 0.1 nH of lead */
+	{{ELEMENT_SHUNT, 0.0f, 0.1e-9f, 0.0f, 0.0f, 0.0f}},
+	/* DUT_CRYSTAL, motional arm only */
+	{{ELEMENT_SHUNT, 10.0f, 10e-3f, 25.33e-15f, 0.0f, 0.0f}},
+	/* DUT_RESONATOR */
+	{{ELEMENT_SERIES, 50.0f, 20e-6f, 3.166e-12f, 0.0f, 0.0f}},
+	/* DUT_LINE */
+	{{ELEMENT_LINE, 75.0f, 0.0f, 0.0f, 10e-9f, 1.0f}},
+	/* DUT_OPEN_LINE */
+	{{ELEMENT_LINE, 50.0f, 0.0f, 0.0f, 20e-9f, 1.0f},
+	 {ELEMENT_SERIES, 0.0f, 0.0f, 1e-15f, 0.0f, 0.0f}},
+	/* DUT_LOWPASS, C-L-C-L-C */
+	{{ELEMENT_SHUNT, 0.0f, 0.0f, 65.57e-12f, 0.0f, 0.0f},
+	 {ELEMENT_SERIES, 0.0f, 429.2e-9f, 0.0f, 0.0f, 0.0f},
+	 {ELEMENT_SHUNT, 0.0f, 0.0f, 212.2e-12f, 0.0f, 0.0f},
+	 {ELEMENT_SERIES, 0.0f, 429.2e-9f, 0.0f, 0.0f, 0.0f},
+	 {ELEMENT_SHUNT, 0.0f, 0.0f, 65.57e-12f, 0.0f, 0.0f}}
+};
+
+static const ReceiverError receiverErrors[2] = {
+	{40.0f, -25.0f, 1.03f, 0.035f},		/* S11 on A0/A1 */
+	{-30.0f, 15.0f, 0.98f, -0.026f}		/* S21 on A8/A6 */
+};
+
+static DutType dutType = DUT_THRU;
+static uint16_t noiseCounts = DUT_DEFAULT_NOISE;
+static long int modelFrequency;
+static Complex exactS11, exactS21;
+static int32_t readings[NUM_ADC14_CHANNELS];	/* Noiseless, about midscale. */
+static uint32_t noiseState = 0x12345678;
+
+static Complex complex(float re, float im)
+{
+	Complex c;
+
+	c.re = re;
+	c.im = im;
+	return c;
+}
+
+static Complex add(Complex a, Complex b)
+{
+	return complex(a.re + b.re, a.im + b.im);
+}
+
+static Complex sub(Complex a, Complex b)
+{
+	return complex(a.re - b.re, a.im - b.im);
+}
+
+static Complex mul(Complex a, Complex b)
+{
+	return complex(a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re);
+}
+
+static Complex scale(Complex a, float k)
+{
+	return complex(a.re * k, a.im * k);
+}
+
+static Complex divide(Complex a, Complex b)
+{
+	float mag2 = b.re * b.re + b.im * b.im;
+
+	return complex((a.re * b.re + a.im * b.im) / mag2,
+			(a.im * b.re - a.re * b.im) / mag2);
+}
+
+static Complex polar(float magnitude, float angle)
+{
+	return complex(magnitude * cosf(angle), magnitude * sinf(angle));
+}
+
+static Complex impedance(const DutElement *e, float omega)
+{
+	float x = omega * e->inductance;
+
+	if(e->capacitance > 0.0f)
+		x -= 1.0f / (omega * e->capacitance);
+	return complex(e->resistance, x);
+}
+
+/* S11 and S21 of a DUT at omega, port 2 matched. */
+static void solveDut(const DutElement *e, float omega, Complex *s11, Complex *s21)
+{
+	Complex a = complex(1.0f, 0.0f), b = complex(0.0f, 0.0f);
+	Complex c = complex(0.0f, 0.0f), d = complex(1.0f, 0.0f);
+	Complex z, y, ch, sh, t;
+	float loss;
+	int i;
+
+	for(i = 0; (i < DUT_MAX_ELEMENTS) && (e[i].kind != ELEMENT_NONE); i++)
+	{
+		switch(e[i].kind)
+		{
+		case ELEMENT_SERIES:
+			z = impedance(&e[i], omega);
+			b = add(b, mul(a, z));
+			d = add(d, mul(c, z));
+			break;
+		case ELEMENT_SHUNT:
+			y = divide(complex(1.0f, 0.0f), impedance(&e[i], omega));
+			a = add(a, mul(b, y));
+			c = add(c, mul(d, y));
+			break;
+		case ELEMENT_LINE:
+			/* cosh and sinh of (loss + j omega delay) */
+			loss = e[i].loss * NEPERS_PER_DB * sqrtf(omega / (TWO_PI * 1e8f));
+			ch = complex(coshf(loss) * cosf(omega * e[i].delay),
+					sinhf(loss) * sinf(omega * e[i].delay));
+			sh = complex(sinhf(loss) * cosf(omega * e[i].delay),
+					coshf(loss) * sinf(omega * e[i].delay));
+			t = add(mul(a, ch), scale(mul(b, sh), 1.0f / e[i].resistance));
+			b = add(scale(mul(a, sh), e[i].resistance), mul(b, ch));
+			a = t;
+			t = add(mul(c, ch), scale(mul(d, sh), 1.0f / e[i].resistance));
+			d = add(scale(mul(c, sh), e[i].resistance), mul(d, ch));
+			c = t;
+			break;
+		default:
+			break;
+		}
+	}
+
+	b = scale(b, 1.0f / Z0);
+	c = scale(c, Z0);
+	t = add(add(a, b), add(c, d));
+	*s11 = divide(sub(add(a, b), add(c, d)), t);
+	*s21 = divide(complex(2.0f, 0.0f), t);
+}
+
+/* What receiver r's I and Q channels read for wave ratio m, in counts. */
+static void receive(int r, Complex m)
+{
+	const ReceiverError *error = &receiverErrors[r];
+
+	readings[2 * r] = (int32_t)(m.re + error->offsetI);
+	readings[2 * r + 1] = (int32_t)(error->gain * (sinf(error->phase) * m.re +
+			cosf(error->phase) * m.im) + error->offsetQ);
+}
+
+void dutModelTune(long int frequency)
+{
+	float omega = TWO_PI * (float)frequency;
+	Complex tracking, directivity, sourceMatch, m;
+
+	modelFrequency = frequency;
+	solveDut(duts[dutType], omega, &exactS11, &exactS21);
+
+	tracking = polar(FE_TRACKING, -omega * 2.0f * FE_PATH_DELAY);
+	directivity = polar(FE_TRACKING * FE_DIRECTIVITY, -omega * FE_DIRECTIVITY_DELAY);
+	sourceMatch = polar(FE_SOURCE_MATCH, -omega * FE_MATCH_DELAY);
+	m = add(directivity, divide(mul(tracking, exactS11),
+			sub(complex(1.0f, 0.0f), mul(sourceMatch, exactS11))));
+	receive(0, m);
+
+	m = add(complex(FE_CROSSTALK, 0.0f),
+			mul(polar(FE_TRANSMISSION, -omega * FE_PATH_DELAY), exactS21));
+	receive(1, m);
+}
+
+/* Roughly gaussian, the sum of four uniform bytes, noiseCounts rms. */
+static int32_t noiseSample(void)
+{
+	uint32_t x = noiseState;
+	int32_t sum;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	noiseState = x;
+	sum = (int32_t)((x & 0xFF) + ((x >> 8) & 0xFF) + ((x >> 16) & 0xFF) + (x >> 24)) - 510;
+	return (sum * noiseCounts * 443) >> 16;		/* One rms is 148. */
+}
+
+int dutModelRead(uint16_t *results)
+{
+	int32_t value;
+	int i;
+
+	for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+	{
+		value = readings[i] + ADC_MIDSCALE + noiseSample();
+		if(value < 0)
+			value = 0;
+		else if(value > ADC_FULL_SCALE)
+			value = ADC_FULL_SCALE;
+		results[i] = (uint16_t)value;
+	}
+	return 1;
+}
+
+bool dutModelSelect(DutType dut, uint16_t noise)
+{
+	if((dut >= NUM_DUTS) | (noise > DUT_MAX_NOISE))
+		return false;
+	dutType = dut;
+	noiseCounts = noise;
+	if(modelFrequency != 0)
+		dutModelTune(modelFrequency);
+	return true;
+}
+
+void printDutModelStatus(void)
+{
+	printf("Dut %d Noise %d", dutType, noiseCounts);
+	if(modelFrequency != 0)
+		printf(" Frequency %l S11 %d %d S21 %d %d", modelFrequency,
+				(int)(exactS11.re * 16384.0f), (int)(exactS11.im * 16384.0f),
+				(int)(exactS21.re * 16384.0f), (int)(exactS21.im * 16384.0f));
+	printf("\r\n");
+}
@@ -0,0 +1,58 @@
+/*
+ * dutModel.h
+ *
+ * Simulated device under test and front end, for building the firmware
+ * with DUT_MODEL defined.  setDDSFrequency() then also tells the model the
+ * frequency, and readADC() returns what the four ADC channels would read
+ * for the chosen DUT instead of converting, so every correction, averaging,
+ * limit, store, TDR and output feature can be run and checked against a
+ * known answer on a bare LaunchPad with no RF board.
+ *
+ * The model is scalar, one point at a time, not vectorised.  It also
+ * builds on a PC: "make -C test bench" from the top of the repository
+ * runs it for every DUT and prints points per second, which on an x86
+ * server is 5 to 17 million with one reading a point.  Its rate on the
+ * M4F has not been measured.
+ *
+ * Each DUT is a cascade of series and shunt RLC elements and lossy
+ * transmission lines between port 1 and a matched port 2.  Its S11 goes
+ * through a one-port error model (directivity, source match and tracking
+ * with a little path delay), its S21 through a transmission tracking and
+ * crosstalk term, and both through the quadrature imbalance and DC offset
+ * that calCorrectIQ() takes out, so an IQ and SOL calibration taken
+ * against DUT_OPEN, DUT_SHORT and DUT_THRU (which is a load at port 1)
+ * corrects the other DUTs the way it would on the bench.
+ *
+ * The readings for a frequency are worked out once when it is tuned;
+ * each readADC() only adds noise, so averaging costs what it does on the
+ * hardware.  With DUT_MODEL defined, "B 2 d n" picks DUT d with about n
+ * ADC counts rms of noise and "B 2" prints the DUT's exact S11 and S21 at
+ * the present frequency, Q14, to compare with what is streamed.
+ */
+
+#ifndef DUTMODEL_H_
+#define DUTMODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+	DUT_THRU = 0,		/* Straight through, so a load at port 1. */
+	DUT_OPEN = 1,
+	DUT_SHORT = 2,
+	DUT_CRYSTAL = 3,	/* 10 MHz series resonant crystal to ground, a deep narrow notch. */
+	DUT_RESONATOR = 4,	/* 20 MHz series RLC in line, Q of 50. */
+	DUT_LINE = 5,		/* 10 ns of lossy 75 ohm line. */
+	DUT_OPEN_LINE = 6,	/* 20 ns of lossy 50 ohm line, open at the far end. */
+	DUT_LOWPASS = 7,	/* 5th order 30 MHz Butterworth low pass. */
+	NUM_DUTS
+} DutType;
+
+#define DUT_DEFAULT_NOISE	2	/* ADC counts rms */
+
+bool dutModelSelect(DutType dut, uint16_t noise);
+void dutModelTune(long int frequency);
+int dutModelRead(uint16_t *results);
+void printDutModelStatus(void);
+
+#endif /* DUTMODEL_H_ */
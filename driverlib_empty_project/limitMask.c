@@ -0,0 +1,153 @@
+/*
+ * limitMask.c
+ *
+ * See limitMask.h.  Limits are kept squared so a point costs a few
+ * multiplies and compares per segment and no square roots.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "uartQueue.h"
+#include "stream.h"
+#include "sol.h"
+#include "limitMask.h"
+
+#define LIMIT_VERDICT_BYTES	9		/* Without the CRC. */
+
+typedef struct LimitSegment {
+	long int startFrequency;	/* Hz, inclusive */
+	long int stopFrequency;		/* Hz, inclusive */
+	uint32_t lower2;			/* |S|^2, 0 = no lower limit */
+	uint32_t upper2;			/* |S|^2, 0 = no upper limit */
+	uint8_t parameter;			/* LimitParameter */
+} LimitSegment;
+
+static LimitSegment segments[LIMIT_MAX_SEGMENTS];
+static uint16_t numSegments;
+static LimitMode limitMode = LIMIT_OFF;
+static bool testing;			/* This sweep is being tested. */
+static uint32_t testSeq;
+static int32_t s11Zero;
+static uint16_t firstFailIndex;
+
+void setLimitMode(LimitMode mode)
+{
+	limitMode = mode;
+}
+
+LimitMode getLimitMode(void)
+{
+	return limitMode;
+}
+
+void clearLimits(void)
+{
+	numSegments = 0;
+}
+
+bool addLimitSegment(LimitParameter parameter, long int startFrequency,
+		long int stopFrequency, uint16_t lower, uint16_t upper)
+{
+	LimitSegment *segment;
+
+	if((numSegments >= LIMIT_MAX_SEGMENTS) | (stopFrequency < startFrequency) |
+			((upper != 0) & (upper < lower)))
+		return false;
+	segment = &segments[numSegments++];
+	segment->parameter = parameter;
+	segment->startFrequency = startFrequency;
+	segment->stopFrequency = stopFrequency;
+	segment->lower2 = (uint32_t)lower * lower;
+	segment->upper2 = (uint32_t)upper * upper;
+	return true;
+}
+
+/*
+ * Returns true if this sweep is being tested, in which case its points
+ * are not sent.
+ */
+bool limitBeginSweep(uint32_t seq, bool corrected)
+{
+	testing = (limitMode != LIMIT_OFF);
+	testSeq = seq;
+	s11Zero = corrected ? SOL_OUTPUT_OFFSET : ADC_MIDSCALE;
+	firstFailIndex = LIMIT_NO_FAILURE;
+	return testing;
+}
+
+static uint32_t magnitude2(int32_t re, int32_t im)
+{
+	return (uint32_t)(re * re) + (uint32_t)(im * im);
+}
+
+/*
+ * Test one point against every segment that covers its frequency.
+ * Returns false when the sweep should stop here.
+ */
+#pragma CODE_SECTION(limitPoint, ".sramcode")
+bool limitPoint(uint16_t index, long int frequency, const uint16_t *results)
+{
+	uint32_t mag2[2];
+	const LimitSegment *segment;
+	int i;
+
+	if(!testing | (firstFailIndex != LIMIT_NO_FAILURE))
+		return true;
+
+	mag2[LIMIT_S11] = magnitude2((int32_t)results[ADC_S11_RE] - s11Zero,
+			(int32_t)results[ADC_S11_IM] - s11Zero);
+	mag2[LIMIT_S21] = magnitude2((int32_t)results[ADC_S21_RE] - ADC_MIDSCALE,
+			(int32_t)results[ADC_S21_IM] - ADC_MIDSCALE);
+	for(i = 0; i < numSegments; i++)
+	{
+		segment = &segments[i];
+		if((frequency < segment->startFrequency) | (frequency > segment->stopFrequency))
+			continue;
+		if((mag2[segment->parameter] < segment->lower2) |
+				((segment->upper2 != 0) & (mag2[segment->parameter] > segment->upper2)))
+		{
+			firstFailIndex = index;
+			return limitMode != LIMIT_TEST_ABORT;
+		}
+	}
+	return true;
+}
+
+/*
+ * Send the verdict.  A sweep cut short without a failure, by a halt or a
+ * new plan, has none.
+ */
+void limitEndSweep(bool complete)
+{
+	uint8_t frame[LIMIT_VERDICT_BYTES + STREAM_CRC_BYTES];
+	bool pass = (firstFailIndex == LIMIT_NO_FAILURE);
+	char *comment = (getOutputFormat() == OUTPUT_TOUCHSTONE) ? "! " : "";
+
+	if(!testing)
+		return;
+	testing = false;
+	if(pass & !complete)
+		return;
+
+	if(getOutputFormat() == OUTPUT_BINARY)
+	{
+		frame[0] = STREAM_SYNC;
+		frame[1] = STREAM_LIMIT_VERDICT;
+		frame[2] = (uint8_t)testSeq;
+		frame[3] = (uint8_t)(testSeq >> 8);
+		frame[4] = (uint8_t)(testSeq >> 16);
+		frame[5] = (uint8_t)(testSeq >> 24);
+		frame[6] = pass;
+		frame[7] = (uint8_t)firstFailIndex;
+		frame[8] = (uint8_t)(firstFailIndex >> 8);
+		streamWriteFrame(frame, LIMIT_VERDICT_BYTES);
+	}
+	else if(pass)
+		printf("%sLimit %n PASS\r\n", comment, testSeq);
+	else
+		printf("%sLimit %n FAIL %d\r\n", comment, testSeq, firstFailIndex);
+}
@@ -0,0 +1,51 @@
+/*
+ * limitMask.h
+ *
+ * Limit mask testing for go/no-go production tests.  The mask is a list
+ * of segments, each an upper and lower limit on |S11| or |S21| over a
+ * frequency range; a one point range limits a single sweep point.
+ * Magnitudes are in the units the sweep would have been sent in: ADC
+ * counts about ADC_MIDSCALE, or for corrected S11 Q14 about
+ * SOL_OUTPUT_OFFSET (see sol.h).
+ *
+ * While testing is on, the points of a tested sweep are not sent.  At
+ * the end of the sweep, or at the first failing point if early abort is
+ * on, one verdict goes out instead:
+ *
+ *   STREAM_SYNC, STREAM_LIMIT_VERDICT, seq(4), pass(1), firstFailIndex(2)
+ *
+ * or in ASCII "Limit <seq> PASS" / "Limit <seq> FAIL <index>", after "! "
+ * in Touchstone output so the file stays valid.  The index is 0xFFFF on
+ * a pass.
+ */
+
+#ifndef LIMITMASK_H_
+#define LIMITMASK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LIMIT_MAX_SEGMENTS	32
+#define LIMIT_NO_FAILURE	0xFFFF
+
+typedef enum {
+	LIMIT_S11 = 0,
+	LIMIT_S21 = 1
+} LimitParameter;
+
+typedef enum {
+	LIMIT_OFF = 0,
+	LIMIT_TEST = 1,			/* Test every point. */
+	LIMIT_TEST_ABORT = 2	/* Stop the sweep at the first failure. */
+} LimitMode;
+
+void setLimitMode(LimitMode mode);
+LimitMode getLimitMode(void);
+void clearLimits(void);
+bool addLimitSegment(LimitParameter parameter, long int startFrequency,
+		long int stopFrequency, uint16_t lower, uint16_t upper);
+bool limitBeginSweep(uint32_t seq, bool corrected);
+bool limitPoint(uint16_t index, long int frequency, const uint16_t *results);
+void limitEndSweep(bool complete);
+
+#endif /* LIMITMASK_H_ */
@@ -1,84 +1,97 @@
-/******************************************************************************
-*
-* Copyright (C) 2012 - 2015 Texas Instruments Incorporated - http://www.ti.com/
-*
-* Redistribution and use in source and binary forms, with or without
-* modification, are permitted provided that the following conditions
-* are met:
-*
-*  Redistributions of source code must retain the above copyright
-*  notice, this list of conditions and the following disclaimer.
-*
-*  Redistributions in binary form must reproduce the above copyright
-*  notice, this list of conditions and the following disclaimer in the
-*  documentation and/or other materials provided with the
-*  distribution.
-*
-*  Neither the name of Texas Instruments Incorporated nor the names of
-*  its contributors may be used to endorse or promote products derived
-*  from this software without specific prior written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
-* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
-* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
-* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
-* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
-* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
-* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
-* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
-* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-*
-* Default linker command file for Texas Instruments MSP432P401R
-*
-* File creation date: 2015-09-03
-*
-*****************************************************************************/
-
---retain=flashMailbox
-
-MEMORY
-{
-    MAIN       (RX) : origin = 0x00000000, length = 0x00040000
-    INFO       (RX) : origin = 0x00200000, length = 0x00004000
-    SRAM_CODE  (RWX): origin = 0x01000000, length = 0x00010000
-    SRAM_DATA  (RW) : origin = 0x20000000, length = 0x00010000
-}
-
-/* The following command line options are set as part of the CCS project.    */
-/* If you are building using the command line, or for some reason want to    */
-/* define them here, you can uncomment and modify these lines as needed.     */
-/* If you are using CCS for building, it is probably better to make any such */
-/* modifications in your CCS project and leave this file alone.              */
-/*                                                                           */
-/* A heap size of 1024 bytes is recommended when you plan to use printf()    */
-/* for debug output to the console window.                                   */
-/*                                                                           */
-/* --heap_size=1024                                                          */
-/* --stack_size=512                                                          */
-/* --library=rtsv7M4_T_le_eabi.lib                                           */
-
-/* Section allocation in memory */
-
-SECTIONS
-{
-    .intvecs:   > 0x00000000
-    .text   :   > MAIN
-    .const  :   > MAIN
-    .cinit  :   > MAIN
-    .pinit  :   > MAIN
-    .init_array  :   > MAIN
-
-    .flashMailbox : > 0x00200000
-
-    .vtable :   > 0x20000000
-    .data   :   > SRAM_DATA
-    .bss    :   > SRAM_DATA
-    .sysmem :   > SRAM_DATA
-    .stack  :   > SRAM_DATA (HIGH)
-}
-
-/* Symbolic definition of the WDTCTL register for RTS */
-WDTCTL_SYM = 0x4000480C;
-
+/******************************************************************************
+*
+* Copyright (C) 2012 - 2015 Texas Instruments Incorporated - http://www.ti.com/
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+*  Redistributions of source code must retain the above copyright
+*  notice, this list of conditions and the following disclaimer.
+*
+*  Redistributions in binary form must reproduce the above copyright
+*  notice, this list of conditions and the following disclaimer in the
+*  documentation and/or other materials provided with the
+*  distribution.
+*
+*  Neither the name of Texas Instruments Incorporated nor the names of
+*  its contributors may be used to endorse or promote products derived
+*  from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* Default linker command file for Texas Instruments MSP432P401R
+*
+* File creation date: 2015-09-03
+*
+*****************************************************************************/
+
+--retain=flashMailbox
+
+MEMORY
+{
+    MAIN       (RX) : origin = 0x00000000, length = 0x00040000
+    /* INFO bank 1 (0x00202000) is the calibration store, see calStore.h. */
+    INFO       (RX) : origin = 0x00200000, length = 0x00002000
+    CAL_INFO   (R)  : origin = 0x00202000, length = 0x00002000
+    /* SRAM_CODE (0x01000000) and SRAM_DATA (0x20000000) are two views of */
+    /* the same 64 KB of SRAM, so they must not overlap.  The top 8 KB is  */
+    /* for code that runs from SRAM; the rest is data and stack.           */
+    SRAM_CODE  (RWX): origin = 0x0100E000, length = 0x00002000
+    SRAM_DATA  (RW) : origin = 0x20000000, length = 0x0000E000
+}
+
+/* The following command line options are set as part of the CCS project.    */
+/* If you are building using the command line, or for some reason want to    */
+/* define them here, you can uncomment and modify these lines as needed.     */
+/* If you are using CCS for building, it is probably better to make any such */
+/* modifications in your CCS project and leave this file alone.              */
+/*                                                                           */
+/* A heap size of 1024 bytes is recommended when you plan to use printf()    */
+/* for debug output to the console window.                                   */
+/*                                                                           */
+/* --heap_size=1024                                                          */
+/* --stack_size=512                                                          */
+/* --library=rtsv7M4_T_le_eabi.lib                                           */
+
+/* Section allocation in memory */
+
+SECTIONS
+{
+    .intvecs:   > 0x00000000
+    .text   :   > MAIN, SIZE(textSize)
+    .const  :   > MAIN, SIZE(constSize)
+    .cinit  :   > MAIN
+    .pinit  :   > MAIN
+    .init_array  :   > MAIN
+    .ovly   :   > MAIN
+
+    /* Interrupt handlers and the sweep loop (#pragma CODE_SECTION         */
+    /* ".sramcode").  Stored in flash and copied to SRAM_CODE by resetISR  */
+    /* so they run with no flash wait states.  The sizes of these sections */
+    /* are printed at boot and listed in the .map file.                    */
+    .sramcode : LOAD = MAIN, RUN = SRAM_CODE, table(sramCodeCopyTable),
+                SIZE(sramCodeSize)
+
+    .flashMailbox : > 0x00200000
+
+    .vtable :   > 0x20000000
+    .data   :   > SRAM_DATA
+    .bss    :   > SRAM_DATA
+    .sysmem :   > SRAM_DATA
+    .stack  :   > SRAM_DATA (HIGH)
+}
+
+/* Symbolic definition of the WDTCTL register for RTS */
+WDTCTL_SYM = 0x4000480C;
+
@@ -11,11 +11,12 @@
 #include "stdarg.h"
 #include <stdint.h>
 #include "driverlib.h"
+#include "uartQueue.h"
 
 
 void sendByte(char c)
 {
-	UART_transmitData(EUSCI_A0_BASE, c);
+	uartQueuePut((uint8_t)c);
 }
 
 static const unsigned long dv[] = {
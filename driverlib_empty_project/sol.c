@@ -0,0 +1,370 @@
+/*
+ * sol.c
+ *
+ * See sol.h.  All the arithmetic is fixed point: raw readings and the
+ * directivity and tracking terms are in ADC counts about ADC_MIDSCALE,
+ * source match is Q15 and the corrected reflection coefficient Q14.
+ *
+ * Built for the M4F with the TI compiler, solPoint() uses the DSP
+ * extension: a complex multiply of packed 16 bit pairs is two dual
+ * multiply instructions, and CLZ finds the normalisation for the
+ * reciprocal.  Anything else gets the same arithmetic in plain C.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "sweep.h"
+#include "calStore.h"
+#include "adaptive.h"
+#include "sol.h"
+
+/* Below this |denominator|^2 the reflection coefficient is off the scale
+ * anyway, and the reciprocal would overflow. */
+#define SOL_MIN_MAG2	(1L << 16)
+
+#define SOL_RECIPROCAL_BITS	16	/* Significant bits of |den|^2 divided by. */
+
+#if defined(__TI_ARM__) && defined(__TI_ARM_V7M4__)
+#define SOL_DSP
+#endif
+
+typedef struct Complex32 {
+	int32_t re;
+	int32_t im;
+} Complex32;
+
+static CalComplex captures[SOL_NUM_STANDARDS][CAL_MAX_SOL_POINTS];
+static SweepPlan capturePlan;
+static uint8_t capturedMask;
+static int armedStandard = -1;
+static int capturingStandard = -1;
+static bool correctionEnabled = true;
+static SolInterpolation solInterpolation = SOL_CUBIC;
+static const CalTerms *pointTerms;	/* 0 when not correcting this sweep. */
+
+/* The terms interpolated onto the plan, and what they were made from. */
+static CalTerms planTerms[SOL_MAX_PLAN_POINTS];
+static bool planTermsValid;
+static SweepPlan termsPlan;
+static const CalPage *termsCal;
+static uint32_t termsSequence;
+static SolInterpolation termsInterpolation;
+
+static int16_t saturate16(int64_t value)
+{
+	if(value > 32767)
+		return 32767;
+	if(value < -32768)
+		return -32768;
+	return (int16_t)value;
+}
+
+static Complex32 toComplex(CalComplex c)
+{
+	Complex32 r;
+
+	r.re = c.re;
+	r.im = c.im;
+	return r;
+}
+
+/*
+ * Complex multiply of packed pairs, re in the low half and im in the
+ * high half as CalComplex lays them out.
+ */
+#ifdef SOL_DSP
+#define MUL_RE(a, b)	_smusd(a, b)
+#define MUL_IM(a, b)	_smuadx(a, b)
+#define LEADING_ZEROS(x)	_norm(x)
+#else
+static int32_t mulRe(uint32_t a, uint32_t b)
+{
+	return (int32_t)(int16_t)a * (int16_t)b - (int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16);
+}
+
+static int32_t mulIm(uint32_t a, uint32_t b)
+{
+	return (int32_t)(int16_t)a * (int16_t)(b >> 16) + (int32_t)(int16_t)(a >> 16) * (int16_t)b;
+}
+
+static int leadingZeros(uint32_t x)
+{
+	int n = 32;
+
+	while(x)
+	{
+		x >>= 1;
+		n--;
+	}
+	return n;
+}
+
+#define MUL_RE(a, b)	mulRe(a, b)
+#define MUL_IM(a, b)	mulIm(a, b)
+#define LEADING_ZEROS(x)	leadingZeros(x)
+#endif
+
+static uint32_t pack(int32_t re, int32_t im)
+{
+	return (uint16_t)re | ((uint32_t)im << 16);
+}
+
+/*
+ * Value at fraction t (Q16) of the way from p[1] to p[2].  Linear uses
+ * just those two; cubic is Catmull-Rom through all four, which passes
+ * through the calibration points and keeps the slope continuous.
+ */
+static int16_t interpolate(int32_t p0, int32_t p1, int32_t p2, int32_t p3, int64_t t)
+{
+	int64_t a, b, c;
+
+	if(solInterpolation == SOL_LINEAR)
+		return saturate16(p1 + (((p2 - p1) * t) >> 16));
+	a = 3 * (p1 - p2) + p3 - p0;
+	b = 2 * p0 - 5 * p1 + 4 * p2 - p3;
+	c = p2 - p0;
+	return saturate16(p1 + ((((((a * t) >> 16) + b) * t >> 16) + c) * t >> 17));
+}
+
+static void interpolateComplex(const CalComplex *p0, const CalComplex *p1,
+		const CalComplex *p2, const CalComplex *p3, int64_t t, CalComplex *result)
+{
+	result->re = interpolate(p0->re, p1->re, p2->re, p3->re, t);
+	result->im = interpolate(p0->im, p1->im, p2->im, p3->im, t);
+}
+
+/*
+ * Fill planTerms for the present plan from the live calibration, unless
+ * it is already up to date.  The plan has to lie inside the calibrated
+ * span; it is never extrapolated.
+ */
+void solPreparePlan(void)
+{
+	const CalPage *cal = activeCal;
+	const CalTerms *p0, *p1, *p2, *p3;
+	long int span;
+	int64_t position, t;
+	uint16_t i, k, last;
+
+	if((cal == termsCal) && (!cal || (cal->sequence == termsSequence)) &&
+			samePlan(&sweepPlan, &termsPlan) && (solInterpolation == termsInterpolation))
+		return;
+	termsCal = cal;
+	termsSequence = cal ? cal->sequence : 0;
+	termsPlan = sweepPlan;
+	termsInterpolation = solInterpolation;
+	planTermsValid = false;
+
+	if(!cal || !(cal->flags & CAL_HAS_SOL) || (cal->solPoints == 0) ||
+			(sweepPlan.numPoints > SOL_MAX_PLAN_POINTS) ||
+			(sweepPlan.startFrequency < cal->solStartFrequency) ||
+			(sweepPlan.stopFrequency > cal->solStopFrequency))
+		return;
+
+	span = cal->solStopFrequency - cal->solStartFrequency;
+	last = cal->solPoints - 1;
+	for(i = 0; i < sweepPlan.numPoints; i++)
+	{
+		/* Position on the calibration grid, Q16. */
+		position = span ? (((int64_t)(sweepPointFrequency(i) - cal->solStartFrequency)
+				* last) << 16) / span : 0;
+		k = (uint16_t)(position >> 16);
+		t = position & 0xFFFF;
+		if(k >= last)
+		{
+			k = last;
+			t = 0;
+		}
+		p1 = &cal->sol[k];
+		p0 = (k > 0) ? p1 - 1 : p1;
+		p2 = (k < last) ? p1 + 1 : p1;
+		p3 = (k + 1 < last) ? p2 + 1 : p2;
+		interpolateComplex(&p0->directivity, &p1->directivity, &p2->directivity,
+				&p3->directivity, t, &planTerms[i].directivity);
+		interpolateComplex(&p0->sourceMatch, &p1->sourceMatch, &p2->sourceMatch,
+				&p3->sourceMatch, t, &planTerms[i].sourceMatch);
+		interpolateComplex(&p0->tracking, &p1->tracking, &p2->tracking,
+				&p3->tracking, t, &planTerms[i].tracking);
+	}
+	planTermsValid = true;
+}
+
+/*
+ * Capture the given standard on the next complete sweep.  All three have
+ * to be taken with the same plan; a capture with a different one starts
+ * the set again.
+ */
+bool solArmCapture(int standard)
+{
+	if((standard < 0) | (standard >= SOL_NUM_STANDARDS) |
+			(sweepPlan.numPoints > CAL_MAX_SOL_POINTS) | adaptiveRefined())
+		return false;
+	armedStandard = standard;
+	return true;
+}
+
+/*
+ * Ideal standards: short -1, open +1, load 0.  With A = Mo - Ml and
+ * B = Ms - Ml,
+ *   e00 = Ml,  e11 = (A + B) / (A - B),  e10e01 = -2AB / (A - B).
+ */
+bool solComputeTerms(void)
+{
+	CalPage *cal;
+	Complex32 load, a, b, num, den;
+	int64_t mag2, abRe, abIm;
+	uint16_t i;
+
+	if(capturedMask != SOL_ALL_CAPTURED)
+		return false;
+
+	cal = calEditPage();
+	for(i = 0; i < capturePlan.numPoints; i++)
+	{
+		load = toComplex(captures[SOL_LOAD][i]);
+		a = toComplex(captures[SOL_OPEN][i]);
+		b = toComplex(captures[SOL_SHORT][i]);
+		a.re -= load.re;
+		a.im -= load.im;
+		b.re -= load.re;
+		b.im -= load.im;
+		num.re = a.re + b.re;
+		num.im = a.im + b.im;
+		den.re = a.re - b.re;
+		den.im = a.im - b.im;
+		mag2 = (int64_t)den.re * den.re + (int64_t)den.im * den.im;
+		if(mag2 == 0)
+			return false;	// Open and short read the same: not connected.
+		abRe = (int64_t)a.re * b.re - (int64_t)a.im * b.im;
+		abIm = (int64_t)a.re * b.im + (int64_t)a.im * b.re;
+
+		cal->sol[i].directivity = captures[SOL_LOAD][i];
+		cal->sol[i].sourceMatch.re = saturate16((((int64_t)num.re * den.re
+				+ (int64_t)num.im * den.im) << 15) / mag2);
+		cal->sol[i].sourceMatch.im = saturate16((((int64_t)num.im * den.re
+				- (int64_t)num.re * den.im) << 15) / mag2);
+		cal->sol[i].tracking.re = saturate16(-2 * (abRe * den.re + abIm * den.im) / mag2);
+		cal->sol[i].tracking.im = saturate16(-2 * (abIm * den.re - abRe * den.im) / mag2);
+	}
+	cal->solStartFrequency = capturePlan.startFrequency;
+	cal->solStopFrequency = capturePlan.stopFrequency;
+	cal->solPoints = capturePlan.numPoints;
+	cal->flags |= CAL_HAS_SOL;
+	return true;
+}
+
+void solSetCorrection(bool enable)
+{
+	correctionEnabled = enable;
+}
+
+void solSetInterpolation(SolInterpolation interpolation)
+{
+	solInterpolation = interpolation;
+}
+
+/*
+ * Called at the start of every sweep.  Starts an armed capture, or
+ * picks up the error terms for this sweep.  Returns true if the sweep
+ * will be corrected.
+ */
+bool solBeginSweep(void)
+{
+	pointTerms = 0;
+	capturingStandard = armedStandard;
+	armedStandard = -1;
+	/* The plan may have changed since the capture was armed. */
+	if((sweepPlan.numPoints > CAL_MAX_SOL_POINTS) | adaptiveRefined())
+		capturingStandard = -1;
+	if(capturingStandard >= 0)
+	{
+		if(!samePlan(&capturePlan, &sweepPlan))
+			capturedMask = 0;
+		capturePlan = sweepPlan;
+		return false;
+	}
+
+	if(correctionEnabled)
+	{
+		solPreparePlan();
+		if(planTermsValid)
+			pointTerms = planTerms;
+	}
+	return pointTerms != 0;
+}
+
+/*
+ * Capture or correct one point.  Runs once per point in the sweep loop,
+ * so it does without a 64 bit divide, which was most of the cost.
+ */
+#pragma CODE_SECTION(solPoint, ".sramcode")
+void solPoint(uint16_t index, uint16_t *results)
+{
+	const CalTerms *terms;
+	Complex32 d, den;
+	uint32_t packedD, packedMatch, high, reciprocal;
+	int64_t mag2;
+	int32_t re, im;
+	int bits, shift;
+
+	if(capturingStandard >= 0)
+	{
+		captures[capturingStandard][index].re = (int16_t)(results[ADC_S11_RE] - ADC_MIDSCALE);
+		captures[capturingStandard][index].im = (int16_t)(results[ADC_S11_IM] - ADC_MIDSCALE);
+		return;
+	}
+	if(pointTerms == 0)
+		return;
+
+	terms = &pointTerms[index];
+	d.re = (int32_t)results[ADC_S11_RE] - ADC_MIDSCALE - terms->directivity.re;
+	d.im = (int32_t)results[ADC_S11_IM] - ADC_MIDSCALE - terms->directivity.im;
+	/* The directivity is itself a reading about midscale, so d fits
+	 * in 16 bits. */
+	packedD = pack(d.re, d.im);
+	packedMatch = pack(terms->sourceMatch.re, terms->sourceMatch.im);
+	den.re = terms->tracking.re + (MUL_RE(packedMatch, packedD) >> 15);
+	den.im = terms->tracking.im + (MUL_IM(packedMatch, packedD) >> 15);
+	mag2 = (int64_t)den.re * den.re + (int64_t)den.im * den.im;
+
+	if(mag2 < SOL_MIN_MAG2)
+	{
+		re = (d.re < 0) ? -32768 : 32767;
+		im = 0;
+	}
+	else
+	{
+		/* G = d conj(den) / |den|^2, in Q14.  |den|^2 is rounded to its
+		 * top SOL_RECIPROCAL_BITS bits so one 32 bit divide gives the
+		 * reciprocal, 2^(32 + shift) / |den|^2, to 1 part in 2^16. */
+		high = (uint32_t)(mag2 >> 32);
+		bits = high ? 64 - LEADING_ZEROS(high) : 32 - LEADING_ZEROS((uint32_t)mag2);
+		shift = bits - SOL_RECIPROCAL_BITS;
+		reciprocal = 0xFFFFFFFFUL / (uint32_t)((mag2 + ((int64_t)1 << (shift - 1))) >> shift);
+		re = (int32_t)((((int64_t)d.re * den.re + (int64_t)d.im * den.im) * reciprocal)
+				>> (18 + shift));
+		im = (int32_t)((((int64_t)d.im * den.re - (int64_t)d.re * den.im) * reciprocal)
+				>> (18 + shift));
+	}
+	results[ADC_S11_RE] = (uint16_t)(saturate16(re) + SOL_OUTPUT_OFFSET);
+	results[ADC_S11_IM] = (uint16_t)(saturate16(im) + SOL_OUTPUT_OFFSET);
+}
+
+/* A capture only counts if the whole sweep was taken. */
+void solEndSweep(bool complete)
+{
+	if((capturingStandard >= 0) & complete)
+		capturedMask |= 1 << capturingStandard;
+	capturingStandard = -1;
+}
+
+void printSolStatus(void)
+{
+	solPreparePlan();
+	printf("Sol Captured %x Armed %d Correcting %d Interpolation %d PlanTerms %d\r\n",
+			capturedMask, armedStandard, correctionEnabled, solInterpolation, planTermsValid);
+}
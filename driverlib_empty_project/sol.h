@@ -0,0 +1,56 @@
+/*
+ * sol.h
+ *
+ * One-port (short, open, load) error correction of S11.
+ *
+ * Calibrating: set the sweep plan (at most CAL_MAX_SOL_POINTS points),
+ * connect each standard in turn and arm a capture of it with "L n"; the
+ * next whole sweep is stored raw.  "L 3" then works out the three error
+ * terms at every point into the working calibration and "K 1" saves it.
+ *
+ * Measuring: the error terms are kept at the calibration frequencies.
+ * When the plan or the calibration changes they are interpolated, complex
+ * linear or Catmull-Rom cubic ("I n"), onto the plan's points into a RAM
+ * table, so each point in the sweep loop is one table lookup.  Any plan
+ * of up to SOL_MAX_PLAN_POINTS points inside the calibrated span can be
+ * corrected; S11 of every point is corrected to
+ *
+ *   G = (M - e00) / (e10e01 + e11 (M - e00))
+ *
+ * and sent in place of the raw S11 I and Q as offset binary Q14, that is
+ * G = (x - SOL_OUTPUT_OFFSET) / 16384 for each part.  Sweeps sent this
+ * way carry STREAM_FLAG_CORRECTED.  S21 is untouched.
+ */
+
+#ifndef SOL_H_
+#define SOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SOL_SHORT	0
+#define SOL_OPEN	1
+#define SOL_LOAD	2
+#define SOL_NUM_STANDARDS	3
+#define SOL_ALL_CAPTURED	((1 << SOL_NUM_STANDARDS) - 1)
+
+#define SOL_OUTPUT_OFFSET	32768
+
+#define SOL_MAX_PLAN_POINTS	512		/* Size of the interpolated table. */
+
+typedef enum {
+	SOL_LINEAR = 0,
+	SOL_CUBIC = 1
+} SolInterpolation;
+
+bool solArmCapture(int standard);
+bool solComputeTerms(void);
+void solSetCorrection(bool enable);
+void solSetInterpolation(SolInterpolation interpolation);
+void solPreparePlan(void);
+bool solBeginSweep(void);
+void solPoint(uint16_t index, uint16_t *results);
+void solEndSweep(bool complete);
+void printSolStatus(void);
+
+#endif /* SOL_H_ */
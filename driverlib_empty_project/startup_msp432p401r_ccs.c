@@ -35,6 +35,7 @@
 //****************************************************************************
 
 #include <stdint.h>
+#include <cpy_tbl.h>
 
 /* Forward declaration of the default fault handlers. */
 static void resetISR(void);
@@ -53,6 +54,9 @@ extern void SystemInit(void);
 /* Linker variable that marks the top of the stack. */
 extern unsigned long __STACK_END;
 
+/* Linker generated copy table for the .sramcode section. */
+extern COPY_TABLE sramCodeCopyTable;
+
 
 /* External declarations for the interrupt handlers used by the application. */
 extern void EusciA0_ISR(void);
@@ -162,6 +166,10 @@ void resetISR(void)
 {
     SystemInit();
 
+    /* Copy the interrupt handlers and sweep loop from flash to SRAM_CODE. */
+    /* This has to happen before _c_int00, which never returns.            */
+    copy_in(&sramCodeCopyTable);
+
     /* Jump to the CCS C Initialization Routine. */
     __asm("    .global _c_int00\n"
           "    b.w     _c_int00");
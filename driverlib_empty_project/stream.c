@@ -0,0 +1,463 @@
+/*
+ * stream.c
+ *
+ * Formats measured points for the host and decides, sweep by sweep,
+ * whether the host has room for them.  See stream.h for the record
+ * layouts and the flow control rules.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "uartQueue.h"
+#include "crc16.h"
+#include "sweep.h"
+#include "sol.h"
+#include "stream.h"
+
+/* Worst case record lengths, binary ones with their CRC.  A record is
+ * only started when the queue has room for it and for the end-of-sweep
+ * record that must follow. */
+#define ASCII_START_BYTES		48
+#define ASCII_POINT_BYTES		(17 + NUM_ADC14_CHANNELS * 26)
+#define ASCII_END_BYTES			48
+#define ASCII_DROPPED_BYTES		24
+#define BINARY_START_BYTES		12
+#define BINARY_POINT_BYTES		STREAM_BINARY_POINT_BYTES
+#define BINARY_END_BYTES		11
+#define BINARY_DROPPED_BYTES	8
+#define TOUCHSTONE_START_BYTES	(ASCII_START_BYTES + 20)
+#define TOUCHSTONE_POINT_BYTES	STREAM_TOUCHSTONE_POINT_BYTES
+#define TOUCHSTONE_END_BYTES	(ASCII_END_BYTES + 2)
+#define TOUCHSTONE_DROPPED_BYTES	(ASCII_DROPPED_BYTES + 2)
+
+#define Q14_ONE		16384
+
+static const uint16_t startBytes[NUM_OUTPUT_FORMATS] = {
+	ASCII_START_BYTES, BINARY_START_BYTES, TOUCHSTONE_START_BYTES
+};
+static const uint16_t pointBytes[NUM_OUTPUT_FORMATS] = {
+	ASCII_POINT_BYTES, BINARY_POINT_BYTES, TOUCHSTONE_POINT_BYTES
+};
+static const uint16_t endBytes[NUM_OUTPUT_FORMATS] = {
+	ASCII_END_BYTES, BINARY_END_BYTES, TOUCHSTONE_END_BYTES
+};
+static const uint16_t droppedBytes[NUM_OUTPUT_FORMATS] = {
+	ASCII_DROPPED_BYTES, BINARY_DROPPED_BYTES, TOUCHSTONE_DROPPED_BYTES
+};
+
+StreamCounters streamCounters;
+
+static OutputFormat outputFormat = OUTPUT_ASCII;
+static bool flowControl;
+static uint16_t credits;
+static bool sending;			/* The sweep in progress is going to the host. */
+static uint32_t sweepSeq;
+static uint8_t sweepFlags;
+static uint16_t sweepPointsDropped;
+
+/* Change detection */
+static bool changeDetection;
+static uint16_t changeThreshold;
+static uint16_t keyframeInterval;
+static uint16_t sweepsSinceKeyframe;
+static bool keyframeNeeded = true;
+static bool tracking;			/* lastSent is kept up to date this sweep. */
+static bool partial;			/* And unchanged points are left out. */
+static SweepPlan trackedPlan;
+static uint16_t lastSent[STREAM_DELTA_MAX_POINTS][NUM_ADC14_CHANNELS];
+
+static uint8_t *put16(uint8_t *p, uint16_t value)
+{
+	*p++ = (uint8_t)value;
+	*p++ = (uint8_t)(value >> 8);
+	return p;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t value)
+{
+	p = put16(p, (uint16_t)value);
+	return put16(p, (uint16_t)(value >> 16));
+}
+
+/*
+ * Fill in the CRC of the first numBytes bytes of frame after them and
+ * queue the lot; frame must have room for STREAM_CRC_BYTES more.
+ */
+#pragma CODE_SECTION(streamWriteFrame, ".sramcode")
+void streamWriteFrame(uint8_t *frame, uint16_t numBytes)
+{
+	put16(&frame[numBytes], crc16(CRC16_INIT, frame, numBytes));
+	uartQueueWrite(frame, numBytes + STREAM_CRC_BYTES);
+}
+
+/*
+ * Queue bytes for the host, waiting for room as the UART drains, however
+ * many there are.  Returns crc carried on over them.
+ */
+uint16_t streamSendBytes(const uint8_t *data, uint32_t numBytes, uint16_t crc)
+{
+	uint16_t chunk;
+
+	crc = crc16(crc, data, numBytes);
+	while(numBytes)
+	{
+		chunk = uartQueueFree();
+		if(chunk > numBytes)
+			chunk = (uint16_t)numBytes;
+		if(chunk == 0)
+			continue;
+		uartQueueWrite(data, chunk);
+		data += chunk;
+		numBytes -= chunk;
+	}
+	return crc;
+}
+
+/* Close a frame's trailing data with the crc of it. */
+void streamSendCrc(uint16_t crc)
+{
+	uint8_t bytes[STREAM_CRC_BYTES];
+
+	put16(bytes, crc);
+	streamSendBytes(bytes, STREAM_CRC_BYTES, crc);
+}
+
+static char *putDecimal(char *p, uint32_t value)
+{
+	char digits[10];
+	int n = 0;
+
+	do
+	{
+		digits[n++] = '0' + value % 10;
+		value /= 10;
+	} while(value);
+	while(n)
+		*p++ = digits[--n];
+	return p;
+}
+
+/* A space and a Q14 value as a decimal with five places. */
+#pragma CODE_SECTION(putQ14, ".sramcode")
+static char *putQ14(char *p, int32_t value)
+{
+	uint32_t fraction;
+	int i;
+
+	*p++ = ' ';
+	if(value < 0)
+	{
+		*p++ = '-';
+		value = -value;
+	}
+	fraction = ((uint32_t)(value & (Q14_ONE - 1)) * 100000 + Q14_ONE / 2) >> 14;
+	if(fraction == 100000)
+	{
+		value += Q14_ONE;
+		fraction = 0;
+	}
+	p = putDecimal(p, (uint32_t)value >> 14);
+	*p++ = '.';
+	for(i = 4; i >= 0; i--)
+	{
+		p[i] = '0' + fraction % 10;
+		fraction /= 10;
+	}
+	return p + 5;
+}
+
+static void sendDroppedMarker(uint32_t seq)
+{
+	uint8_t frame[BINARY_DROPPED_BYTES];
+
+	if(uartQueueFree() < droppedBytes[outputFormat])
+		return;
+	if(outputFormat == OUTPUT_BINARY)
+	{
+		frame[0] = STREAM_SYNC;
+		frame[1] = STREAM_DROPPED;
+		put32(&frame[2], seq);
+		streamWriteFrame(frame, BINARY_DROPPED_BYTES - STREAM_CRC_BYTES);
+	}
+	else if(outputFormat == OUTPUT_TOUCHSTONE)
+		printf("! Dropped %n\r\n", seq);
+	else
+		printf("Dropped %n\r\n", seq);
+}
+
+void initializeStream(void)
+{
+	streamCounters.sweepsSent = 0;
+	streamCounters.sweepsDropped = 0;
+	streamCounters.sweepsTruncated = 0;
+	streamCounters.pointsDropped = 0;
+	streamCounters.pointsUnchanged = 0;
+	sending = false;
+	streamDisableFlowControl();
+}
+
+void setOutputFormat(OutputFormat format)
+{
+	outputFormat = format;
+	keyframeNeeded = true;
+}
+
+void setChangeDetection(bool enable, uint16_t threshold, uint16_t interval)
+{
+	changeDetection = enable;
+	changeThreshold = threshold;
+	keyframeInterval = interval;
+	keyframeNeeded = true;
+}
+
+void getChangeDetection(bool *enable, uint16_t *threshold, uint16_t *interval)
+{
+	*enable = changeDetection;
+	*threshold = changeThreshold;
+	*interval = keyframeInterval;
+}
+
+/* Decide whether this sweep is a keyframe, a partial sweep or neither. */
+static void beginChangeDetection(void)
+{
+	tracking = changeDetection & (outputFormat == OUTPUT_BINARY) &
+			(sweepPlan.numPoints <= STREAM_DELTA_MAX_POINTS);
+	partial = false;
+	if(!tracking)
+		return;
+
+	if(!samePlan(&sweepPlan, &trackedPlan))
+	{
+		trackedPlan = sweepPlan;
+		keyframeNeeded = true;
+	}
+	if(keyframeInterval && (sweepsSinceKeyframe >= keyframeInterval))
+		keyframeNeeded = true;
+
+	if(keyframeNeeded)
+	{
+		keyframeNeeded = false;
+		sweepsSinceKeyframe = 0;
+		sweepFlags |= STREAM_FLAG_KEYFRAME;
+	}
+	else
+	{
+		partial = true;
+		sweepFlags |= STREAM_FLAG_PARTIAL;
+	}
+	sweepsSinceKeyframe++;
+}
+
+/* True if any channel has moved more than the threshold since it was sent. */
+#pragma CODE_SECTION(pointChanged, ".sramcode")
+static bool pointChanged(uint16_t index, const uint16_t *results)
+{
+	int i, change;
+
+	for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+	{
+		change = (int)results[i] - (int)lastSent[index][i];
+		if((change > changeThreshold) | (-change > changeThreshold))
+			return true;
+	}
+	return false;
+}
+
+OutputFormat getOutputFormat(void)
+{
+	return outputFormat;
+}
+
+/*
+ * The first credit from the host switches on flow control; from then on
+ * the UART queue never blocks and late sweeps are dropped instead.
+ */
+void streamGrantCredits(uint16_t newCredits)
+{
+	flowControl = true;
+	uartQueueSetBlocking(false);
+	if(newCredits > STREAM_MAX_CREDITS - credits)
+		credits = STREAM_MAX_CREDITS;
+	else
+		credits += newCredits;
+}
+
+void streamDisableFlowControl(void)
+{
+	flowControl = false;
+	credits = 0;
+	uartQueueSetBlocking(true);
+}
+
+bool streamFlowControl(void)
+{
+	return flowControl;
+}
+
+uint16_t streamCredits(void)
+{
+	return credits;
+}
+
+/*
+ * Returns true if the sweep will be sent.  A sweep that is not sent
+ * still has to be measured by the caller so the sequence numbers the
+ * host sees reflect real time.
+ */
+bool streamBeginSweep(uint32_t seq, uint16_t numPoints)
+{
+	uint8_t frame[BINARY_START_BYTES];
+
+	sweepSeq = seq;
+	sweepFlags = 0;
+	sweepPointsDropped = 0;
+	sending = false;
+	tracking = false;
+	partial = false;
+
+	if(flowControl)
+	{
+		if((credits == 0) | (uartQueueFree() <
+				startBytes[outputFormat] + endBytes[outputFormat]))
+		{
+			streamCounters.sweepsDropped++;
+			sendDroppedMarker(seq);
+			return false;
+		}
+		credits--;
+	}
+
+	if(outputFormat == OUTPUT_BINARY)
+	{
+		frame[0] = STREAM_SYNC;
+		frame[1] = STREAM_SWEEP_START;
+		put16(put16(put32(&frame[2], seq), numPoints),
+				(uint16_t)streamCounters.sweepsDropped);
+		streamWriteFrame(frame, BINARY_START_BYTES - STREAM_CRC_BYTES);
+		beginChangeDetection();
+	}
+	else if(outputFormat == OUTPUT_TOUCHSTONE)
+		printf("! Sweep %n Points %d Dropped %n\r\n# HZ S RI R 50\r\n", seq,
+				numPoints, streamCounters.sweepsDropped);
+	else
+		printf("\r\nSweep %n Points %d Dropped %n\r\n", seq, numPoints,
+				streamCounters.sweepsDropped);
+	sending = true;
+	return true;
+}
+
+#pragma CODE_SECTION(streamPoint, ".sramcode")
+void streamPoint(uint16_t index, const uint16_t *results)
+{
+	uint8_t frame[BINARY_POINT_BYTES];
+	char line[TOUCHSTONE_POINT_BYTES];
+	uint8_t *p;
+	char *l;
+	int i;
+
+	if(!sending)
+		return;
+
+	/* Once a sweep overruns the queue the rest of it is dropped, so the
+	 * host sees a clean prefix rather than a sweep with holes in it. */
+	if(flowControl && ((sweepFlags & STREAM_FLAG_TRUNCATED) |
+			(uartQueueFree() < pointBytes[outputFormat] + endBytes[outputFormat])))
+	{
+		sweepFlags |= STREAM_FLAG_TRUNCATED;
+		sweepPointsDropped++;
+		streamCounters.pointsDropped++;
+		return;
+	}
+
+	if(partial && !pointChanged(index, results))
+	{
+		streamCounters.pointsUnchanged++;
+		return;
+	}
+	if(tracking)
+		for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+			lastSent[index][i] = results[i];
+
+	if(outputFormat == OUTPUT_BINARY)
+	{
+		frame[0] = STREAM_SYNC;
+		frame[1] = STREAM_POINT;
+		p = put16(&frame[2], index);
+		for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+			p = put16(p, results[i]);
+		streamWriteFrame(frame, BINARY_POINT_BYTES - STREAM_CRC_BYTES);
+	}
+	else if(outputFormat == OUTPUT_TOUCHSTONE)
+	{
+		/* Formatted by hand into one line: printf has no fractions, and
+		 * this is many times quicker. */
+		l = putDecimal(line, (uint32_t)sweepPointFrequency(index));
+		for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+			if(((i == ADC_S11_RE) | (i == ADC_S11_IM)) && (sweepFlags & STREAM_FLAG_CORRECTED))
+				l = putQ14(l, (int32_t)results[i] - SOL_OUTPUT_OFFSET);
+			else
+				l = putQ14(l, ((int32_t)results[i] - ADC_MIDSCALE) * (Q14_ONE / ADC_MIDSCALE));
+		memcpy(l, " 0 0 0 0\r\n", 10);	// S12 and S22 are not measured.
+		uartQueueWrite((uint8_t *)line, l + 10 - line);
+	}
+	else
+	{
+		printf("\r\n Results are:\r\n");
+		for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+		{
+			printf("ADC # %d  \r\n", i);
+			printf("Result: %d\n\r", results[i]);
+		}
+	}
+}
+
+void streamFlagSweep(uint8_t flags)
+{
+	sweepFlags |= flags;
+}
+
+void streamEndSweep(void)
+{
+	uint8_t frame[BINARY_END_BYTES];
+
+	if(!sending)
+		return;
+	sending = false;
+
+	if(sweepFlags & STREAM_FLAG_TRUNCATED)
+	{
+		streamCounters.sweepsTruncated++;
+		keyframeNeeded = true;	// The host is missing points.
+	}
+	streamCounters.sweepsSent++;
+
+	if(outputFormat == OUTPUT_BINARY)
+	{
+		frame[0] = STREAM_SYNC;
+		frame[1] = STREAM_SWEEP_END;
+		put32(&frame[2], sweepSeq);
+		frame[6] = sweepFlags;
+		put16(&frame[7], sweepPointsDropped);
+		streamWriteFrame(frame, BINARY_END_BYTES - STREAM_CRC_BYTES);
+	}
+	else if(outputFormat == OUTPUT_TOUCHSTONE)
+		printf("! End %n Flags %d Dropped %d\r\n", sweepSeq, sweepFlags,
+				sweepPointsDropped);
+	else
+		printf("End %n Flags %d Dropped %d\r\n", sweepSeq, sweepFlags,
+				sweepPointsDropped);
+}
+
+void printStreamStatus(void)
+{
+	printf("Status Sent %n Dropped %n Truncated %n PointsDropped %n",
+			streamCounters.sweepsSent, streamCounters.sweepsDropped,
+			streamCounters.sweepsTruncated, streamCounters.pointsDropped);
+	printf(" Unchanged %n TxOverruns %n RxOverruns %n Credits %d\r\n",
+			streamCounters.pointsUnchanged, uartTxOverruns, uartRxOverruns, credits);
+}
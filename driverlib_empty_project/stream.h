@@ -0,0 +1,134 @@
+/*
+ * stream.h
+ *
+ * Sweep output records and host flow control.
+ *
+ * ASCII output keeps the "Results are: / ADC # n / Result: x" lines the
+ * original firmware printed, with one line marking the start and end of
+ * each sweep.  Binary output uses small fixed-size frames, little endian:
+ *
+ *   STREAM_SYNC, STREAM_SWEEP_START, seq(4), numPoints(2), sweepsDropped(2)
+ *   STREAM_SYNC, STREAM_POINT, index(2), S11_Re(2), S11_Im(2), S21_Re(2), S21_Im(2)
+ *   STREAM_SYNC, STREAM_SWEEP_END, seq(4), flags(1), pointsDropped(2)
+ *   STREAM_SYNC, STREAM_DROPPED, seq(4)
+ *
+ * The variable length STREAM_TRACE_REPORT frame is described in trace.c,
+ * STREAM_STORE_BURST and STREAM_STORE_POINT in sweepStore.h,
+ * STREAM_LIMIT_VERDICT in limitMask.h, STREAM_TDR in tdr.h and
+ * STREAM_FREQUENCY_LIST in adaptive.h.
+ *
+ * Every binary frame is followed by a CRC-16 (crc16.h) of all its bytes
+ * from STREAM_SYNC on, little endian; the layouts above leave it out.
+ * The frame type gives the length, or for the variable length frames a
+ * length field does, so a host that gets a bad CRC or an unknown type
+ * drops one byte, looks for the next STREAM_SYNC and tries again.
+ *
+ * Touchstone output is Touchstone 1.0 .s2p text, one whole file per sweep
+ * from its "! Sweep" comment line to its "! End" one, so the host can
+ * write each sweep straight out to its own file a line at a time:
+ *
+ *   ! Sweep seq Points numPoints Dropped sweepsDropped
+ *   # HZ S RI R 50
+ *   frequency S11re S11im S21re S21im 0 0 0 0
+ *   ...
+ *   ! End seq Flags flags Dropped pointsDropped
+ *
+ * Corrected S11 is the reflection coefficient; otherwise a reading is
+ * given as a fraction of ADC full scale about midscale.  S12 and S22 are
+ * not measured and are written as 0.
+ *
+ * Flow control is off until the host sends its first credit.  After that
+ * each sweep costs one credit; a sweep that starts with no credit left is
+ * still measured but only a STREAM_DROPPED marker is sent for it, and a
+ * sweep that outruns the transmit queue is cut short and flagged
+ * STREAM_FLAG_TRUNCATED.  The measurement loop never waits on the UART.
+ * A sweep with points measured on the wrong VersaClock band is flagged
+ * STREAM_FLAG_BUS_FAULT, and one with a conversion that timed out, sent
+ * as midscale on every channel, STREAM_FLAG_ADC_TIMEOUT.
+ *
+ * Change detection (binary output, plans of up to STREAM_DELTA_MAX_POINTS
+ * points) remembers what was last sent for each point and leaves out
+ * points where no channel moved by more than the threshold.  Such sweeps
+ * are flagged STREAM_FLAG_PARTIAL, and the host rebuilds them by keeping
+ * its previous value for every point that is missing.  A keyframe,
+ * flagged STREAM_FLAG_KEYFRAME, sends every point: the first sweep, any
+ * sweep after the plan or format changes or a sweep was truncated, and
+ * otherwise every keyframeInterval sweeps sent.
+ */
+
+#ifndef STREAM_H_
+#define STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STREAM_SYNC			0xA5
+#define STREAM_SWEEP_START	0x01
+#define STREAM_POINT		0x02
+#define STREAM_SWEEP_END	0x03
+#define STREAM_DROPPED		0x04
+#define STREAM_TRACE_REPORT	0x05
+#define STREAM_STORE_BURST	0x06
+#define STREAM_LIMIT_VERDICT	0x07
+#define STREAM_TDR			0x08
+#define STREAM_STORE_POINT	0x09
+#define STREAM_FREQUENCY_LIST	0x0A
+
+#define STREAM_FLAG_TRUNCATED	0x01
+#define STREAM_FLAG_BUS_FAULT	0x02	/* VersaClock not retuned for some points. */
+#define STREAM_FLAG_CORRECTED	0x04	/* S11 is error corrected, see sol.h. */
+#define STREAM_FLAG_KEYFRAME	0x08	/* Every point sent. */
+#define STREAM_FLAG_PARTIAL		0x10	/* Only the points that moved. */
+#define STREAM_FLAG_ADAPTIVE	0x20	/* Points on a refined list, see adaptive.h. */
+#define STREAM_FLAG_ADC_TIMEOUT	0x40	/* Some points read as midscale. */
+
+/* Bytes each point puts on the wire: exact for binary, typical (four
+ * digit results) for ASCII. */
+#define STREAM_BINARY_POINT_BYTES	14
+#define STREAM_ASCII_POINT_BYTES	117
+#define STREAM_TOUCHSTONE_POINT_BYTES	54	/* At most. */
+
+#define STREAM_CRC_BYTES	2
+
+#define STREAM_DELTA_MAX_POINTS	512
+
+/* Most sweeps the host may have outstanding at once. */
+#define STREAM_MAX_CREDITS	16
+
+typedef enum {
+	OUTPUT_ASCII = 0,
+	OUTPUT_BINARY = 1,
+	OUTPUT_TOUCHSTONE = 2
+} OutputFormat;
+
+#define NUM_OUTPUT_FORMATS	3
+
+typedef struct StreamCounters {
+	uint32_t sweepsSent;
+	uint32_t sweepsDropped;		/* No credit when the sweep started. */
+	uint32_t sweepsTruncated;	/* Transmit queue overran mid sweep. */
+	uint32_t pointsDropped;
+	uint32_t pointsUnchanged;	/* Left out by change detection. */
+} StreamCounters;
+
+extern StreamCounters streamCounters;
+
+void initializeStream(void);
+void setOutputFormat(OutputFormat format);
+OutputFormat getOutputFormat(void);
+void setChangeDetection(bool enable, uint16_t threshold, uint16_t keyframeInterval);
+void getChangeDetection(bool *enable, uint16_t *threshold, uint16_t *keyframeInterval);
+void streamWriteFrame(uint8_t *frame, uint16_t numBytes);
+uint16_t streamSendBytes(const uint8_t *data, uint32_t numBytes, uint16_t crc);
+void streamSendCrc(uint16_t crc);
+void streamGrantCredits(uint16_t credits);
+void streamDisableFlowControl(void);
+bool streamFlowControl(void);
+uint16_t streamCredits(void);
+bool streamBeginSweep(uint32_t seq, uint16_t numPoints);
+void streamPoint(uint16_t index, const uint16_t *results);
+void streamFlagSweep(uint8_t flags);
+void streamEndSweep(void);
+void printStreamStatus(void);
+
+#endif /* STREAM_H_ */
@@ -0,0 +1,327 @@
+/*
+ * sweep.c
+ *
+ * Steps the DDS and VersaClock through the sweep plan and hands each
+ * set of ADC results to the stream code.  Measuring never waits on the
+ * host: whether a sweep actually goes out is decided in stream.c.
+ */
+
+/* DriverLib Includes */
+#include "driverlib.h"
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "vna.h"
+#include "stream.h"
+#include "sweep.h"
+#include "trace.h"
+#include "timer.h"
+#include "calStore.h"
+#include "sol.h"
+#include "sweepStore.h"
+#include "average.h"
+#include "limitMask.h"
+#include "trigger.h"
+#include "tdr.h"
+#include "adaptive.h"
+
+/* Until the host asks for something else we measure the 1 MHz test tone,
+ * which is what the firmware always did. */
+SweepPlan sweepPlan = {1000000, 1000000, 1, 0, 0, 0};
+
+/* The order serviceSweep() runs the stages of a point in, for the bus
+ * timing model.  Keep the two in step. */
+const BusStage sweepStageOrder[SWEEP_NUM_STAGES] = {
+	STAGE_DDS, STAGE_VERSACLOCK, STAGE_SETTLE, STAGE_ADC, STAGE_OUTPUT
+};
+
+static SweepMode sweepMode = SWEEP_IDLE;
+static uint16_t pointIndex;
+static uint32_t sweepSeq;
+static long int presentFrequency = -1;
+static int presentBand = -1;
+
+/* Replay of the raw sweeps in the store in place of the hardware. */
+static bool replaying;
+static bool replayPaced;		/* At the pace they were recorded. */
+static uint32_t replaySweeps;	/* Left to run. */
+static uint16_t replayIndex;	/* Stored sweep this one comes from. */
+static uint32_t replayStart;	/* timerTicks() at the start of the pass. */
+static const StoreHeader *replayHeader;
+
+/* Flags go with the sweep wherever it is going. */
+static void flagSweep(uint8_t flags)
+{
+	streamFlagSweep(flags);
+	storeFlagSweep(flags);
+}
+
+static void finishSweep(void)
+{
+	solEndSweep(pointIndex >= sweepPlan.numPoints);
+	averageEndSweep(pointIndex >= sweepPlan.numPoints);
+	limitEndSweep(pointIndex >= sweepPlan.numPoints);
+	storeEndSweep(pointIndex >= sweepPlan.numPoints);
+	streamEndSweep();
+	tdrEndSweep(pointIndex >= sweepPlan.numPoints);
+	if(adaptiveEndSweep(pointIndex >= sweepPlan.numPoints))
+	{
+		sweepPlan.numPoints = sweepPlan.adaptivePoints;
+		sweepPlan.refinement++;
+		solPreparePlan();
+	}
+	pointIndex = 0;
+	sweepSeq++;
+
+	if(!replaying)
+		return;
+	if(--replaySweeps == 0)
+	{
+		replaying = false;
+		sweepMode = SWEEP_IDLE;
+		presentFrequency = -1;	// presentBand is the replay's, not the hardware's.
+	}
+	else if(++replayIndex >= storeRawSweeps())
+	{
+		replayIndex = 0;
+		replayStart = timerTicks();
+	}
+}
+
+bool setSweepPlan(long int startFrequency, long int stopFrequency, uint16_t numPoints)
+{
+	if((numPoints < 1) | (numPoints > MAX_SWEEP_POINTS))
+		return false;
+	if((startFrequency < MIN_FREQUENCY) | (stopFrequency > MAX_FREQUENCY) |
+			(stopFrequency < startFrequency))
+		return false;
+
+	/* A new plan starts a new sweep rather than splicing into this one,
+	 * and ends a replay. */
+	if(pointIndex != 0)
+		finishSweep();
+	replaying = false;
+	adaptiveStop();
+	sweepPlan.startFrequency = startFrequency;
+	sweepPlan.stopFrequency = stopFrequency;
+	sweepPlan.numPoints = numPoints;
+	sweepPlan.coarsePoints = 0;
+	sweepPlan.adaptivePoints = 0;
+	solPreparePlan();
+	return true;
+}
+
+/*
+ * Sweep coarsePoints linearly spaced points once, then numPoints in all
+ * placed where the first sweep changed most (see adaptive.h).
+ */
+bool setAdaptivePlan(long int startFrequency, long int stopFrequency,
+		uint16_t coarsePoints, uint16_t numPoints)
+{
+	if((coarsePoints < 2) | (coarsePoints > ADAPT_MAX_COARSE_POINTS) |
+			(numPoints <= coarsePoints) | (numPoints > MAX_SWEEP_POINTS))
+		return false;
+	if(!setSweepPlan(startFrequency, stopFrequency, coarsePoints))
+		return false;
+	sweepPlan.coarsePoints = coarsePoints;
+	sweepPlan.adaptivePoints = numPoints;
+	adaptiveStart(coarsePoints, numPoints);
+	return true;
+}
+
+/* Set a plan saved from sweepPlan again.  An adaptive one starts over
+ * from its coarse sweep. */
+bool restoreSweepPlan(const SweepPlan *plan)
+{
+	if(plan->coarsePoints != 0)
+		return setAdaptivePlan(plan->startFrequency, plan->stopFrequency,
+				plan->coarsePoints, plan->adaptivePoints);
+	return setSweepPlan(plan->startFrequency, plan->stopFrequency, plan->numPoints);
+}
+
+/* Whether results taken on one plan line up point for point with the
+ * other's, for everything that keeps results or terms from sweep to sweep. */
+bool samePlan(const SweepPlan *a, const SweepPlan *b)
+{
+	return (a->startFrequency == b->startFrequency) &
+			(a->stopFrequency == b->stopFrequency) & (a->numPoints == b->numPoints) &
+			(a->coarsePoints == b->coarsePoints) & (a->refinement == b->refinement);
+}
+
+long int sweepPointFrequency(uint16_t index)
+{
+	if(adaptiveRefined())
+		return adaptiveFrequency(index);
+	if(sweepPlan.numPoints < 2)
+		return sweepPlan.startFrequency;
+	return sweepPlan.startFrequency + (long int)(((long long)(sweepPlan.stopFrequency
+			- sweepPlan.startFrequency) * index) / (sweepPlan.numPoints - 1));
+}
+
+void startSweep(SweepMode mode)
+{
+	if(pointIndex != 0)
+		finishSweep();
+	replaying = false;
+	sweepMode = mode;
+}
+
+void haltSweep(void)
+{
+	if(pointIndex != 0)
+		finishSweep();
+	replaying = false;
+	sweepMode = SWEEP_IDLE;
+}
+
+/*
+ * Run the raw sweeps in the store through the sweep loop repeats times
+ * over, in place of the DDS and ADC, as fast as they will go or at the
+ * pace they were recorded.  The recording stops so the replay cannot
+ * overwrite itself, and the plan becomes the one it was recorded with.
+ * Sweeps on a refined adaptive list cannot be replayed, as the header
+ * does not say where the points were.
+ */
+bool startReplay(uint16_t repeats, bool paced)
+{
+	const StoreHeader *first;
+
+	if((storeRawSweeps() == 0) | (repeats == 0) ||
+			(storeSweep(0)->flags & STREAM_FLAG_ADAPTIVE))
+		return false;
+	haltSweep();
+	storeStop();
+	first = storeSweep(0);
+	if(!setSweepPlan(first->startFrequency, first->stopFrequency, first->numPoints))
+		return false;
+	replaySweeps = (uint32_t)storeRawSweeps() * repeats;
+	replayIndex = 0;
+	replayPaced = paced;
+	replayStart = timerTicks();
+	replaying = true;
+	sweepMode = SWEEP_CONTINUOUS;
+	return true;
+}
+
+/* Whether the next replayed sweep is due; if so it becomes replayHeader. */
+static bool replayDue(void)
+{
+	replayHeader = storeSweep(replayIndex);
+	return !replayPaced || timerElapsed(replayStart,
+			replayHeader->startTicks - storeSweep(0)->startTicks);
+}
+
+/* Tune if need be and take the ADC readings for one point. */
+#pragma CODE_SECTION(measurePoint, ".sramcode")
+static void measurePoint(long int frequency, uint16_t *results)
+{
+	int i;
+
+	if(frequency != presentFrequency)
+	{
+		TRACE_BEGIN(TRACE_SET_DDS_FREQUENCY);
+		setDDSFrequency(frequency);
+		TRACE_END(TRACE_SET_DDS_FREQUENCY);
+		TRACE_BEGIN(TRACE_UPDATE_VERSACLOCK_REGS);
+		/* If the bus gave up, measure anyway so the sweep stays in step,
+		 * flag it, and retune again at the next point. */
+		if(updateVersaclockRegs(frequency) == VERSACLOCK_BUS_FAULT)
+		{
+			flagSweep(STREAM_FLAG_BUS_FAULT);
+			presentFrequency = -1;
+		}
+		else
+			presentFrequency = frequency;
+		TRACE_END(TRACE_UPDATE_VERSACLOCK_REGS);
+		presentBand = versaclockBand(frequency);
+		delayMicroseconds(calSettleMicroseconds(presentBand));
+	}
+
+	/* Pulse the start of a conversion. */
+	GPIO_toggleOutputOnPin(GPIO_PORT_P3, GPIO_PIN5);
+	TRACE_BEGIN(TRACE_ADC_CONVERSION);
+	/* A conversion that never finished reads as no signal, flagged. */
+	if(!readADC(results))
+	{
+		for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+			results[i] = ADC_MIDSCALE;
+		flagSweep(STREAM_FLAG_ADC_TIMEOUT);
+	}
+	TRACE_END(TRACE_ADC_CONVERSION);
+	storeRawPoint(pointIndex, results);
+}
+
+SweepMode getSweepMode(void)
+{
+	return sweepMode;
+}
+
+/*
+ * Measure the next point of the plan.  Called once per trip around the
+ * main loop.
+ */
+#pragma CODE_SECTION(serviceSweep, ".sramcode")
+void serviceSweep(void)
+{
+	uint16_t results[NUM_ADC14_CHANNELS];
+	long int frequency;
+	bool corrected, aborted, reading;
+
+	/* A store read goes out a piece at a time between points, and a
+	 * sweep that would be sent waits for it. */
+	reading = storeService(pointIndex == 0);
+	if(sweepMode == SWEEP_IDLE)
+		return;
+	if((pointIndex == 0) && (reading || !(replaying ? replayDue() : triggerSweep())))
+		return;
+
+	TRACE_BEGIN(TRACE_SWEEP_POINT);
+	if(pointIndex == 0)
+	{
+		corrected = solBeginSweep();
+		/* A sweep that is only averaged goes nowhere, a limit tested one
+		 * only sends its verdict, and one going into the store is not
+		 * streamed.  Only a streamed sweep is transformed. */
+		if(averageBeginSweep() && !limitBeginSweep(sweepSeq, corrected) &&
+				!storeBeginSweep(sweepSeq) && streamBeginSweep(sweepSeq, sweepPlan.numPoints))
+			tdrBeginSweep(sweepSeq, corrected);
+		if(corrected)
+			flagSweep(STREAM_FLAG_CORRECTED);
+		if(adaptiveRefined())
+			flagSweep(STREAM_FLAG_ADAPTIVE);
+	}
+
+	frequency = sweepPointFrequency(pointIndex);
+	if(replaying)
+	{
+		storeReadings(replayHeader, pointIndex, results);
+		presentBand = versaclockBand(frequency);
+	}
+	else
+		measurePoint(frequency, results);
+
+	TRACE_BEGIN(TRACE_CORRECT_POINT);
+	calCorrectIQ(presentBand, results);
+	solPoint(pointIndex, results);
+	TRACE_END(TRACE_CORRECT_POINT);
+	adaptivePoint(pointIndex, results);
+	averagePoint(pointIndex, results);
+	aborted = !limitPoint(pointIndex, frequency, results);
+	storePoint(pointIndex, results);
+	tdrPoint(pointIndex, results);
+	TRACE_BEGIN(TRACE_STREAM_POINT);
+	streamPoint(pointIndex, results);
+	TRACE_END(TRACE_STREAM_POINT);
+
+	if((++pointIndex >= sweepPlan.numPoints) | aborted)
+	{
+		finishSweep();
+		/* Heartbeat LED, one toggle per sweep. */
+		GPIO_toggleOutputOnPin(GPIO_PORT_P1, GPIO_PIN0);
+		if(sweepMode == SWEEP_SINGLE)
+			sweepMode = SWEEP_IDLE;
+	}
+	TRACE_END(TRACE_SWEEP_POINT);
+}
@@ -0,0 +1,53 @@
+/*
+ * sweep.h
+ *
+ * The sweep engine.  A sweep plan is a start and stop frequency and a
+ * number of linearly spaced points, or for an adaptive plan points placed
+ * by adaptive.c.  serviceSweep() measures one point
+ * per call so the main loop can keep servicing commands between points.
+ */
+
+#ifndef SWEEP_H_
+#define SWEEP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "busModel.h"
+
+#define MAX_SWEEP_POINTS	10001
+#define SWEEP_SETTLE_US		300		/* DDS and PLL settling after a frequency change. */
+
+typedef struct SweepPlan {
+	long int startFrequency;	/* Hz */
+	long int stopFrequency;		/* Hz */
+	uint16_t numPoints;
+	uint16_t coarsePoints;		/* 0 unless adaptive, see adaptive.h. */
+	uint16_t adaptivePoints;	/* An adaptive plan's points once refined. */
+	uint16_t refinement;		/* Counts each time adaptive points move. */
+} SweepPlan;
+
+typedef enum {
+	SWEEP_IDLE,
+	SWEEP_SINGLE,
+	SWEEP_CONTINUOUS
+} SweepMode;
+
+#define SWEEP_NUM_STAGES	5
+
+extern SweepPlan sweepPlan;
+extern const BusStage sweepStageOrder[SWEEP_NUM_STAGES];
+
+bool setSweepPlan(long int startFrequency, long int stopFrequency, uint16_t numPoints);
+bool setAdaptivePlan(long int startFrequency, long int stopFrequency,
+		uint16_t coarsePoints, uint16_t numPoints);
+bool restoreSweepPlan(const SweepPlan *plan);
+bool samePlan(const SweepPlan *a, const SweepPlan *b);
+long int sweepPointFrequency(uint16_t index);
+void startSweep(SweepMode mode);
+void haltSweep(void);
+bool startReplay(uint16_t repeats, bool paced);
+SweepMode getSweepMode(void);
+void serviceSweep(void);
+
+#endif /* SWEEP_H_ */
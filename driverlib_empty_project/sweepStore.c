@@ -0,0 +1,416 @@
+/*
+ * sweepStore.c
+ *
+ * The store is a ring of equal sized slots, one sweep each, sized from
+ * the plan when it is armed.  Within a slot the results are stored by
+ * channel, so storePoint() scatters each point across the columns.  A
+ * sweep only takes its slot once it is complete, so a halted sweep never
+ * replaces a good one.
+ *
+ * A read is set up by the command and sent by storeService(), at most
+ * STORE_READOUT_CHUNK bytes and only what the UART queue has room for
+ * each pass, so the sweep loop never waits on the UART.  Whatever is
+ * not a sweep body waits in readoutBytes until it fits whole.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "uartQueue.h"
+#include "stream.h"
+#include "crc16.h"
+#include "sweep.h"
+#include "timer.h"
+#include "sweepStore.h"
+
+#define STORE_POINT_BYTES	(NUM_ADC14_CHANNELS * sizeof(uint16_t))
+#define STORE_BURST_BYTES	8		/* Header, without the CRC. */
+#define STORE_POINT_READ_BYTES	6	/* Header, without the CRC. */
+/* One sweep of a point read. */
+#define STORE_RECORD_BYTES	(8 + STORE_POINT_BYTES)
+#define STORE_READOUT_CHUNK	256		/* Bytes queued per pass at most. */
+
+static uint32_t storeBuffer[STORE_BYTES / sizeof(uint32_t)];
+static SweepPlan storePlan;
+static uint16_t slotBytes;
+static uint16_t numSlots;
+static uint16_t nextSlot;		/* Where the sweep being recorded goes. */
+static uint16_t storedSweeps;
+static uint16_t maxStored;		/* A ring keeps nextSlot out of the count. */
+static uint16_t sweepsToStore;	/* 0 in ring mode. */
+static bool armed;
+static bool recording;			/* The sweep in progress is being stored. */
+static bool raw;				/* Readings are stored before correction. */
+static bool paused;				/* Sweeps go past the store, which stays armed. */
+
+/* The read in progress. */
+static uint16_t readoutSlot;	/* Slot being sent. */
+static uint16_t readoutLeft;	/* Sweeps still to send, that one included. */
+static uint16_t readoutOffset;	/* Bytes of that slot sent. */
+static bool readoutPoint;		/* A point read, of point readoutIndex. */
+static uint16_t readoutIndex;
+static uint16_t readoutCrc;
+static bool readoutTrailer;		/* The closing CRC is still to come. */
+static uint8_t readoutBytes[STORE_RECORD_BYTES + STREAM_CRC_BYTES];
+static uint8_t readoutPending;	/* Bytes of readoutBytes waiting for room. */
+
+static StoreHeader *slotHeader(uint16_t slot)
+{
+	return (StoreHeader *)((uint8_t *)storeBuffer + (uint32_t)slot * slotBytes);
+}
+
+/* The first result of channel in the sweep after header. */
+static uint16_t *column(const StoreHeader *header, int channel)
+{
+	return (uint16_t *)(header + 1) + (uint32_t)channel * storePlan.numPoints;
+}
+
+/* Slot of the index'th oldest stored sweep. */
+static uint16_t storedSlot(uint16_t index)
+{
+	return (nextSlot + numSlots - storedSweeps + index) % numSlots;
+}
+
+/* Whether the read in progress has yet to send slot. */
+static bool readoutNeeds(uint16_t slot)
+{
+	return (slot + numSlots - readoutSlot) % numSlots < readoutLeft;
+}
+
+/* Leave a frame header with its CRC for storeService() to send. */
+static void pendFrame(uint16_t numBytes)
+{
+	uint16_t crc = crc16(CRC16_INIT, readoutBytes, numBytes);
+
+	readoutBytes[numBytes] = (uint8_t)crc;
+	readoutBytes[numBytes + 1] = (uint8_t)(crc >> 8);
+	readoutPending = numBytes + STREAM_CRC_BYTES;
+}
+
+/* Set up a burst of numSweeps stored sweeps from the first'th oldest. */
+static void startBurst(uint16_t first, uint16_t numSweeps)
+{
+	uint32_t numBytes = (uint32_t)numSweeps * slotBytes;
+
+	readoutBytes[0] = STREAM_SYNC;
+	readoutBytes[1] = STREAM_STORE_BURST;
+	readoutBytes[2] = (uint8_t)numSweeps;
+	readoutBytes[3] = (uint8_t)(numSweeps >> 8);
+	readoutBytes[4] = (uint8_t)numBytes;
+	readoutBytes[5] = (uint8_t)(numBytes >> 8);
+	readoutBytes[6] = (uint8_t)(numBytes >> 16);
+	readoutBytes[7] = (uint8_t)(numBytes >> 24);
+	pendFrame(STORE_BURST_BYTES);
+	readoutSlot = numSweeps ? storedSlot(first) : 0;
+	readoutLeft = numSweeps;
+	readoutOffset = 0;
+	readoutPoint = false;
+	readoutCrc = CRC16_INIT;
+	readoutTrailer = true;
+}
+
+/*
+ * Start recording with the present plan, throwing away whatever was
+ * stored.  Fails if not even one sweep of the plan fits, or for a ring,
+ * two: one slot is always left for the sweep being recorded, so it never
+ * lands on a stored sweep that may still be read.
+ */
+bool storeArm(uint16_t numSweeps, uint8_t options)
+{
+	bool ring = (options & STORE_RING) != 0;
+	uint32_t bytes = sizeof(StoreHeader) +
+			(uint32_t)sweepPlan.numPoints * STORE_POINT_BYTES;
+
+	if((numSweeps == 0) | (bytes > (ring ? STORE_BYTES / 2 : STORE_BYTES)))
+		return false;
+	storePlan = sweepPlan;
+	slotBytes = (uint16_t)bytes;
+	numSlots = STORE_BYTES / slotBytes;
+	if(!ring && (numSweeps < numSlots))
+		numSlots = numSweeps;
+	maxStored = ring ? numSlots - 1 : numSlots;
+	sweepsToStore = ring ? 0 : numSlots;
+	nextSlot = 0;
+	storedSweeps = 0;
+	recording = false;
+	raw = (options & STORE_RAW) != 0;
+	armed = true;
+	return true;
+}
+
+void storeStop(void)
+{
+	armed = false;
+	recording = false;
+}
+
+/* Let sweeps by without storing them or stopping the recording, for the
+ * benchmarks. */
+void storePause(bool pause)
+{
+	paused = pause;
+}
+
+/*
+ * Returns true if this sweep is being stored, in which case it is not
+ * streamed.  Changing the plan stops the recording.  A sweep that would
+ * land on a slot still to be read is not stored or streamed either.
+ */
+bool storeBeginSweep(uint32_t seq)
+{
+	StoreHeader *header;
+
+	recording = false;
+	if(!armed | paused)
+		return false;
+	if(!samePlan(&sweepPlan, &storePlan))
+	{
+		armed = false;
+		return false;
+	}
+	if(readoutNeeds(nextSlot))
+		return true;
+	header = slotHeader(nextSlot);
+	header->seq = seq;
+	header->startTicks = timerTicks();
+	header->startFrequency = storePlan.startFrequency;
+	header->stopFrequency = storePlan.stopFrequency;
+	header->numPoints = storePlan.numPoints;
+	header->flags = 0;
+	header->storeFlags = raw ? STORE_RAW : 0;
+	recording = true;
+	return true;
+}
+
+#pragma CODE_SECTION(writePoint, ".sramcode")
+static void writePoint(uint16_t index, const uint16_t *results)
+{
+	StoreHeader *header = slotHeader(nextSlot);
+	int i;
+
+	for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+		column(header, i)[index] = results[i];
+}
+
+/* Readings straight from the ADC, for a raw recording. */
+#pragma CODE_SECTION(storeRawPoint, ".sramcode")
+void storeRawPoint(uint16_t index, const uint16_t *results)
+{
+	if(recording & raw)
+		writePoint(index, results);
+}
+
+/* Results as they would have been streamed. */
+#pragma CODE_SECTION(storePoint, ".sramcode")
+void storePoint(uint16_t index, const uint16_t *results)
+{
+	if(recording & !raw)
+		writePoint(index, results);
+}
+
+void storeFlagSweep(uint8_t flags)
+{
+	if(recording)
+		slotHeader(nextSlot)->flags |= flags;
+}
+
+void storeEndSweep(bool complete)
+{
+	if(!recording)
+		return;
+	recording = false;
+	if(!complete)
+		return;
+	nextSlot = (nextSlot + 1) % numSlots;
+	if(storedSweeps < maxStored)
+		storedSweeps++;
+	if(sweepsToStore && (storedSweeps == sweepsToStore))
+		armed = false;
+}
+
+/* How many raw sweeps there are to replay. */
+uint16_t storeRawSweeps(void)
+{
+	return raw ? storedSweeps : 0;
+}
+
+/* The index'th oldest stored sweep. */
+const StoreHeader *storeSweep(uint16_t index)
+{
+	return slotHeader(storedSlot(index));
+}
+
+/* Gather point index of a stored sweep back into channel order. */
+#pragma CODE_SECTION(storeReadings, ".sramcode")
+void storeReadings(const StoreHeader *header, uint16_t index, uint16_t *results)
+{
+	int i;
+
+	for(i = 0; i < NUM_ADC14_CHANNELS; i++)
+		results[i] = column(header, i)[index];
+}
+
+void storeSendBurst(void)
+{
+	startBurst(0, storedSweeps);
+}
+
+/*
+ * Send every stored sweep numbered seq or later.  The oldest is first and
+ * stored sequence numbers only go up from it, so a reader that finds the
+ * first one it gets is past seq knows it was lapped.  If they ever did
+ * not, nothing is sent rather than a wrong answer to that check.
+ */
+bool storeSendFrom(uint32_t seq)
+{
+	uint16_t i;
+
+	for(i = 1; i < storedSweeps; i++)
+		if((int32_t)(slotHeader(storedSlot(i))->seq -
+				slotHeader(storedSlot(i - 1))->seq) <= 0)
+			return false;
+	for(i = 0; i < storedSweeps; i++)
+		if((int32_t)(slotHeader(storedSlot(i))->seq - seq) >= 0)
+			break;
+	startBurst(i, storedSweeps - i);
+	return true;
+}
+
+/* Send one stored sweep, found by its sequence number. */
+bool storeSendSweep(uint32_t seq)
+{
+	uint16_t i;
+
+	for(i = 0; i < storedSweeps; i++)
+		if(slotHeader(storedSlot(i))->seq == seq)
+		{
+			startBurst(i, 1);
+			return true;
+		}
+	return false;
+}
+
+/* Send point index of every stored sweep, a strided read down the store. */
+bool storeSendPoint(uint16_t index)
+{
+	if(index >= storePlan.numPoints)
+		return false;
+
+	readoutBytes[0] = STREAM_SYNC;
+	readoutBytes[1] = STREAM_STORE_POINT;
+	readoutBytes[2] = (uint8_t)storedSweeps;
+	readoutBytes[3] = (uint8_t)(storedSweeps >> 8);
+	readoutBytes[4] = (uint8_t)index;
+	readoutBytes[5] = (uint8_t)(index >> 8);
+	pendFrame(STORE_POINT_READ_BYTES);
+	readoutSlot = storedSweeps ? storedSlot(0) : 0;
+	readoutLeft = storedSweeps;
+	readoutOffset = 0;
+	readoutPoint = true;
+	readoutIndex = index;
+	readoutCrc = CRC16_INIT;
+	readoutTrailer = true;
+	return true;
+}
+
+/* Queue the next piece of the read: a chunk of a sweep, or one record of
+ * a point read. */
+static void sendReadout(uint16_t room)
+{
+	const StoreHeader *header = slotHeader(readoutSlot);
+	const uint8_t *data;
+	uint16_t chunk, value;
+	int c;
+
+	if(readoutPoint)
+	{
+		if(room < STORE_RECORD_BYTES)
+			return;
+		memcpy(readoutBytes, &header->seq, 4);
+		memcpy(&readoutBytes[4], &header->startTicks, 4);
+		for(c = 0; c < NUM_ADC14_CHANNELS; c++)
+		{
+			value = column(header, c)[readoutIndex];
+			readoutBytes[8 + 2 * c] = (uint8_t)value;
+			readoutBytes[9 + 2 * c] = (uint8_t)(value >> 8);
+		}
+		readoutCrc = crc16(readoutCrc, readoutBytes, STORE_RECORD_BYTES);
+		uartQueueWrite(readoutBytes, STORE_RECORD_BYTES);
+		readoutOffset = slotBytes;
+	}
+	else
+	{
+		chunk = slotBytes - readoutOffset;
+		if(chunk > room)
+			chunk = room;
+		if(chunk > STORE_READOUT_CHUNK)
+			chunk = STORE_READOUT_CHUNK;
+		if(chunk == 0)
+			return;
+		data = (const uint8_t *)header + readoutOffset;
+		readoutCrc = crc16(readoutCrc, data, chunk);
+		uartQueueWrite(data, chunk);
+		readoutOffset += chunk;
+	}
+
+	if(readoutOffset == slotBytes)
+	{
+		readoutSlot = (readoutSlot + 1) % numSlots;
+		readoutOffset = 0;
+		readoutLeft--;
+	}
+}
+
+/*
+ * Called every pass of the sweep loop.  Sends the next piece of a read
+ * when the sweep in progress is not being streamed.  Returns true while
+ * a read is going, for the caller to hold back sweeps that would be
+ * sent; sweeps going into the store carry on.
+ */
+bool storeService(bool betweenSweeps)
+{
+	uint16_t room;
+
+	if(!storeReading())
+		return false;
+	if(betweenSweeps | recording)
+	{
+		room = uartQueueFree();
+		if(readoutPending <= room)
+		{
+			uartQueueWrite(readoutBytes, readoutPending);
+			room -= readoutPending;
+			readoutPending = 0;
+			if(readoutLeft)
+				sendReadout(room);
+			else if(readoutTrailer)
+			{
+				readoutBytes[0] = (uint8_t)readoutCrc;
+				readoutBytes[1] = (uint8_t)(readoutCrc >> 8);
+				readoutPending = STREAM_CRC_BYTES;
+				readoutTrailer = false;
+			}
+		}
+	}
+	return storeReading() && !(armed && samePlan(&sweepPlan, &storePlan));
+}
+
+/* Whether a read has yet to finish. */
+bool storeReading(void)
+{
+	return (readoutLeft != 0) | (readoutPending != 0) | readoutTrailer;
+}
+
+void printStoreStatus(void)
+{
+	printf("Store Armed %d Raw %d Stored %d Slots %d SlotBytes %d Reading %d", armed,
+			raw, storedSweeps, numSlots, slotBytes, storeReading());
+	if(storedSweeps)
+		printf(" First %n Last %n", slotHeader(storedSlot(0))->seq,
+				slotHeader(storedSlot(storedSweeps - 1))->seq);
+	printf("\r\n");
+}
@@ -0,0 +1,97 @@
+/*
+ * sweepStore.h
+ *
+ * Multi-sweep result store in SRAM.  "G k" records the next k complete
+ * sweeps of the present plan into STORE_BYTES of RAM instead of sending
+ * them, so sweeps can run back to back at full speed; "G k 1" keeps
+ * recording, overwriting the oldest, until "G 0".  The host then pulls
+ * the lot as one STREAM_STORE_BURST frame with "Y", or a single sweep by
+ * sequence number with "Y seq".
+ *
+ * Reads go out a piece at a time between sweep points, as the UART queue
+ * has room, so the sweep loop never waits on the UART.  Until a read has
+ * all gone, further commands wait and sweeps that would be sent are held
+ * back.
+ *
+ * "G k 2" and "G k 3" do the same but store the ADC readings as they come
+ * in, before any correction, and mark the sweeps STORE_RAW.  Raw sweeps
+ * are what the replay benchmark (benchmark.h) feeds back through the
+ * sweep loop.
+ *
+ * In ring mode the store can also be read while it records, and the
+ * sweeps carry on being measured and stored while a read goes out.  Any
+ * number of readers each keep the sequence number they want next and ask
+ * with "Y seq 1" for everything from there on; the store keeps no state
+ * per reader.  A reader whose first sweep back is numbered past the one
+ * it asked for was lapped and has lost the sweeps in between.  A sweep
+ * that would overwrite one still being sent is not stored, so sequence
+ * numbers have gaps there as well as wherever else a sweep was not
+ * stored.
+ *
+ * "Z index" reads one frequency point of every stored sweep, for
+ * watching a point over time without moving whole sweeps:
+ *
+ *   STREAM_SYNC, STREAM_STORE_POINT, numSweeps(2), index(2), crc(2),
+ *   { seq(4), startTicks(4), S11_Re(2), S11_Im(2), S21_Re(2), S21_Im(2) }
+ *   * numSweeps, crc(2)
+ *
+ * oldest first, the second CRC again over what follows the first.
+ *
+ * Each stored sweep is a StoreHeader followed by its results a channel
+ * at a time: numPoints little endian uint16 S11 Re, then as many S11 Im,
+ * S21 Re and S21 Im, with the same values streamPoint() would have sent.
+ * The burst is a frame on the stream like any other,
+ *
+ *   STREAM_SYNC, STREAM_STORE_BURST, numSweeps(2), numBytes(4), crc(2),
+ *   sweeps..., crc(2)
+ *
+ * with the sweeps oldest first.  The first CRC covers the frame header as
+ * for any other frame, the second the numBytes bytes of sweeps.  It is
+ * not a file format: there is no index, and a host wanting a columnar
+ * file to map has to strip the framing and write its own.  Every sweep
+ * of a burst is the same numBytes / numSweeps long, so sweep k starts k
+ * of those in and its channel c 20 + 2 * c * numPoints bytes further.
+ */
+
+#ifndef SWEEPSTORE_H_
+#define SWEEPSTORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STORE_BYTES		16384
+
+/* storeArm() options, and StoreHeader.storeFlags */
+#define STORE_RING		0x01
+#define STORE_RAW		0x02
+
+typedef struct StoreHeader {
+	uint32_t seq;
+	uint32_t startTicks;		/* timerTicks() at the first point. */
+	int32_t startFrequency;		/* Hz */
+	int32_t stopFrequency;		/* Hz */
+	uint16_t numPoints;
+	uint8_t flags;				/* STREAM_FLAG_... */
+	uint8_t storeFlags;			/* STORE_RAW */
+} StoreHeader;
+
+bool storeArm(uint16_t numSweeps, uint8_t options);
+void storeStop(void);
+void storePause(bool pause);
+bool storeBeginSweep(uint32_t seq);
+void storeRawPoint(uint16_t index, const uint16_t *results);
+void storePoint(uint16_t index, const uint16_t *results);
+void storeFlagSweep(uint8_t flags);
+void storeEndSweep(bool complete);
+uint16_t storeRawSweeps(void);
+const StoreHeader *storeSweep(uint16_t index);
+void storeReadings(const StoreHeader *header, uint16_t index, uint16_t *results);
+void storeSendBurst(void);
+bool storeSendSweep(uint32_t seq);
+bool storeSendPoint(uint16_t index);
+bool storeSendFrom(uint32_t seq);
+bool storeService(bool betweenSweeps);
+bool storeReading(void);
+void printStoreStatus(void);
+
+#endif /* SWEEPSTORE_H_ */
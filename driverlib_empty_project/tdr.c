@@ -0,0 +1,347 @@
+/*
+ * tdr.c
+ *
+ * See tdr.h.  The spectrum is collected as the sweep runs and transformed
+ * once it is complete: a radix-2 inverse FFT in place, in 32 bit fixed
+ * point with a halving at every stage so nothing can overflow.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "printf.h"
+#include "vna.h"
+#include "uartQueue.h"
+#include "stream.h"
+#include "sweep.h"
+#include "sol.h"
+#include "trace.h"
+#include "adaptive.h"
+#include "tdr.h"
+
+#define TDR_HEADER_BYTES	13
+#define TDR_FRAME_BYTES		(TDR_HEADER_BYTES + 2 * TDR_FFT_SIZE)
+#define QUARTER_TURN		(TDR_FFT_SIZE / 4)
+#define Q14_ONE				16384
+#define Q15_ONE				32768
+
+typedef struct Complex32 {
+	int32_t re;
+	int32_t im;
+} Complex32;
+
+/* sin(2 pi i / TDR_FFT_SIZE) for the first quarter turn, Q15. */
+static const int16_t quarterSine[QUARTER_TURN + 1] = {
+	0, 402, 804, 1206, 1608, 2009, 2411, 2811,
+	3212, 3612, 4011, 4410, 4808, 5205, 5602, 5998,
+	6393, 6787, 7180, 7571, 7962, 8351, 8740, 9127,
+	9512, 9896, 10279, 10660, 11039, 11417, 11793, 12167,
+	12540, 12910, 13279, 13646, 14010, 14373, 14733, 15091,
+	15447, 15800, 16151, 16500, 16846, 17190, 17531, 17869,
+	18205, 18538, 18868, 19195, 19520, 19841, 20160, 20475,
+	20788, 21097, 21403, 21706, 22006, 22302, 22595, 22884,
+	23170, 23453, 23732, 24008, 24279, 24548, 24812, 25073,
+	25330, 25583, 25833, 26078, 26320, 26557, 26791, 27020,
+	27246, 27467, 27684, 27897, 28106, 28311, 28511, 28707,
+	28899, 29086, 29269, 29448, 29622, 29792, 29957, 30118,
+	30274, 30425, 30572, 30715, 30853, 30986, 31114, 31238,
+	31357, 31471, 31581, 31686, 31786, 31881, 31972, 32058,
+	32138, 32214, 32286, 32352, 32413, 32470, 32522, 32568,
+	32610, 32647, 32679, 32706, 32729, 32746, 32758, 32766,
+	32767
+};
+
+static TdrMode tdrMode;
+static TdrWindow tdrWindow = TDR_HANN;
+static bool active;				/* This sweep is being transformed. */
+static bool rawReadings;		/* S11 is not corrected. */
+static uint32_t tdrSeq;
+static uint16_t numPoints;
+static uint32_t tdrSent;
+static uint32_t tdrSkipped;		/* Plan does not suit, or no room to send. */
+static Complex32 spectrum[TDR_FFT_SIZE];
+static uint8_t frame[TDR_FRAME_BYTES + STREAM_CRC_BYTES];
+
+/* sin(2 pi angle / TDR_FFT_SIZE), Q15. */
+static int32_t sine(uint32_t angle)
+{
+	uint32_t i = angle % QUARTER_TURN;
+
+	switch((angle / QUARTER_TURN) & 3)
+	{
+	case 0:
+		return quarterSine[i];
+	case 1:
+		return quarterSine[QUARTER_TURN - i];
+	case 2:
+		return -quarterSine[i];
+	default:
+		return -quarterSine[QUARTER_TURN - i];
+	}
+}
+
+static int32_t cosine(uint32_t angle)
+{
+	return sine(angle + QUARTER_TURN);
+}
+
+/* Window weight, Q15, at x (Q16) of the way across it; the peak is at 1/2. */
+static int32_t windowWeight(uint32_t x)
+{
+	uint32_t angle = (x * TDR_FFT_SIZE + 0x8000) >> 16;
+
+	switch(tdrWindow)
+	{
+	case TDR_HANN:
+		return (Q15_ONE - cosine(angle)) >> 1;
+	case TDR_BLACKMAN:	/* 0.42 - 0.5 cos + 0.08 cos 2x */
+		return 13763 - (cosine(angle) >> 1) + ((cosine(2 * angle) * 2621) >> 15);
+	default:
+		return Q15_ONE;
+	}
+}
+
+static int32_t saturate(int32_t value)
+{
+	if(value > 32767)
+		return 32767;
+	if(value < -32768)
+		return -32768;
+	return value;
+}
+
+static uint32_t squareRoot(uint32_t value)
+{
+	uint32_t root = 0, bit = 1UL << 30;
+
+	while(bit > value)
+		bit >>= 2;
+	while(bit)
+	{
+		if(value >= root + bit)
+		{
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+			root >>= 1;
+		bit >>= 2;
+	}
+	return root;
+}
+
+static void scale(Complex32 *c, int32_t weight)
+{
+	c->re = (c->re * weight) >> 15;
+	c->im = (c->im * weight) >> 15;
+}
+
+/*
+ * Window the captured points and fill in the rest of the spectrum.
+ * Returns the sum of the weights, Q15.
+ */
+static int32_t windowSpectrum(void)
+{
+	int32_t weight, sum = 0;
+	uint16_t k;
+
+	if(tdrMode == TDR_BANDPASS)
+	{
+		for(k = 0; k < numPoints; k++)
+		{
+			weight = windowWeight(((uint32_t)k << 16) / (numPoints - 1));
+			scale(&spectrum[k], weight);
+			sum += weight;
+		}
+		for(; k < TDR_FFT_SIZE; k++)
+			spectrum[k].re = spectrum[k].im = 0;
+		return sum;
+	}
+
+	/* Low pass: DC is real, so take the real part of the straight line
+	 * through the first two points.  Then mirror for a real response. */
+	spectrum[0].re = saturate(2 * spectrum[1].re - spectrum[2].re);
+	spectrum[0].im = 0;
+	weight = windowWeight(1UL << 15);
+	scale(&spectrum[0], weight);
+	sum = weight;
+	for(k = 1; k <= numPoints; k++)
+	{
+		weight = windowWeight((1UL << 15) + ((uint32_t)k << 15) / numPoints);
+		scale(&spectrum[k], weight);
+		spectrum[TDR_FFT_SIZE - k].re = spectrum[k].re;
+		spectrum[TDR_FFT_SIZE - k].im = -spectrum[k].im;
+		sum += 2 * weight;
+	}
+	for(; k < TDR_FFT_SIZE - numPoints; k++)
+		spectrum[k].re = spectrum[k].im = 0;
+	return sum;
+}
+
+/* In place inverse FFT, divided by TDR_FFT_SIZE. */
+static void inverseTransform(void)
+{
+	Complex32 t, *a, *b;
+	int32_t c, s;
+	uint16_t i, j, bit, half, step, k, start;
+
+	for(i = 0; i < TDR_FFT_SIZE; i++)
+	{
+		for(j = 0, bit = 0; bit < TDR_FFT_BITS; bit++)
+			j |= ((i >> bit) & 1) << (TDR_FFT_BITS - 1 - bit);
+		if(j > i)
+		{
+			t = spectrum[i];
+			spectrum[i] = spectrum[j];
+			spectrum[j] = t;
+		}
+	}
+
+	for(half = 1, step = TDR_FFT_SIZE / 2; half < TDR_FFT_SIZE; half <<= 1, step >>= 1)
+		for(k = 0; k < half; k++)
+		{
+			c = cosine(k * step);
+			s = sine(k * step);
+			for(start = 0; start < TDR_FFT_SIZE; start += 2 * half)
+			{
+				a = &spectrum[start + k];
+				b = a + half;
+				t.re = (b->re * c - b->im * s) >> 15;
+				t.im = (b->re * s + b->im * c) >> 15;
+				b->re = (a->re - t.re) >> 1;
+				b->im = (a->im - t.im) >> 1;
+				a->re = (a->re + t.re) >> 1;
+				a->im = (a->im + t.im) >> 1;
+			}
+		}
+}
+
+void setTdr(TdrMode mode, TdrWindow window)
+{
+	tdrMode = mode;
+	tdrWindow = window;
+}
+
+void getTdr(TdrMode *mode, TdrWindow *window)
+{
+	*mode = tdrMode;
+	*window = tdrWindow;
+}
+
+/*
+ * Called for every sweep that is being streamed.  The transform is only
+ * done for binary output and a plan that suits the mode.
+ */
+void tdrBeginSweep(uint32_t seq, bool corrected)
+{
+	active = false;
+	if((tdrMode == TDR_OFF) | (getOutputFormat() != OUTPUT_BINARY))
+		return;
+	numPoints = sweepPlan.numPoints;
+	if((numPoints < 2) | (sweepPlan.stopFrequency == sweepPlan.startFrequency) |
+			adaptiveRefined() |
+			(numPoints > ((tdrMode == TDR_LOWPASS) ?
+			TDR_MAX_LOWPASS_POINTS : TDR_MAX_BANDPASS_POINTS)) ||
+			((tdrMode == TDR_LOWPASS) && ((int64_t)sweepPlan.startFrequency
+			* (numPoints - 1) != sweepPlan.stopFrequency - sweepPlan.startFrequency)))
+	{
+		tdrSkipped++;
+		return;
+	}
+	tdrSeq = seq;
+	rawReadings = !corrected;
+	active = true;
+}
+
+#pragma CODE_SECTION(tdrPoint, ".sramcode")
+void tdrPoint(uint16_t index, const uint16_t *results)
+{
+	Complex32 *c;
+
+	if(!active)
+		return;
+	c = &spectrum[(tdrMode == TDR_LOWPASS) ? index + 1 : index];
+	if(rawReadings)
+	{
+		c->re = ((int32_t)results[ADC_S11_RE] - ADC_MIDSCALE) * (Q14_ONE / ADC_MIDSCALE);
+		c->im = ((int32_t)results[ADC_S11_IM] - ADC_MIDSCALE) * (Q14_ONE / ADC_MIDSCALE);
+	}
+	else
+	{
+		c->re = (int32_t)results[ADC_S11_RE] - SOL_OUTPUT_OFFSET;
+		c->im = (int32_t)results[ADC_S11_IM] - SOL_OUTPUT_OFFSET;
+	}
+}
+
+/* Transform a complete sweep and send it. */
+void tdrEndSweep(bool complete)
+{
+	uint64_t binPicoseconds, gain;
+	int32_t sum, value;
+	uint16_t n;
+	uint8_t *p;
+
+	if(!active)
+		return;
+	active = false;
+	if(!complete)
+		return;
+	if(streamFlowControl() && (uartQueueFree() < TDR_FRAME_BYTES + STREAM_CRC_BYTES))
+	{
+		tdrSkipped++;
+		return;
+	}
+
+	TRACE_BEGIN(TRACE_TDR_TRANSFORM);
+	sum = windowSpectrum();
+	if(sum == 0)
+	{
+		tdrSkipped++;	// Two points under a window that is zero at both.
+		return;
+	}
+	inverseTransform();
+
+	/* The FFT divided by TDR_FFT_SIZE; the window's gain is the sum of
+	 * its weights. */
+	gain = ((uint64_t)TDR_FFT_SIZE << 31) / (uint32_t)sum;
+	binPicoseconds = 1000000000000ULL * (numPoints - 1) / ((uint64_t)TDR_FFT_SIZE
+			* (sweepPlan.stopFrequency - sweepPlan.startFrequency));
+	if(binPicoseconds > 0xFFFFFFFFUL)
+		binPicoseconds = 0xFFFFFFFFUL;
+
+	frame[0] = STREAM_SYNC;
+	frame[1] = STREAM_TDR;
+	frame[2] = (uint8_t)tdrSeq;
+	frame[3] = (uint8_t)(tdrSeq >> 8);
+	frame[4] = (uint8_t)(tdrSeq >> 16);
+	frame[5] = (uint8_t)(tdrSeq >> 24);
+	frame[6] = tdrMode;
+	frame[7] = (uint8_t)TDR_FFT_SIZE;
+	frame[8] = (uint8_t)(TDR_FFT_SIZE >> 8);
+	frame[9] = (uint8_t)binPicoseconds;
+	frame[10] = (uint8_t)(binPicoseconds >> 8);
+	frame[11] = (uint8_t)(binPicoseconds >> 16);
+	frame[12] = (uint8_t)(binPicoseconds >> 24);
+	p = &frame[TDR_HEADER_BYTES];
+	for(n = 0; n < TDR_FFT_SIZE; n++)
+	{
+		if(tdrMode == TDR_LOWPASS)
+			value = spectrum[n].re;
+		else
+			value = (int32_t)squareRoot((uint32_t)(spectrum[n].re * spectrum[n].re)
+					+ (uint32_t)(spectrum[n].im * spectrum[n].im));
+		value = saturate((int32_t)((value * (int64_t)gain) >> 16));
+		*p++ = (uint8_t)value;
+		*p++ = (uint8_t)(value >> 8);
+	}
+	TRACE_END(TRACE_TDR_TRANSFORM);
+	streamWriteFrame(frame, TDR_FRAME_BYTES);
+	tdrSent++;
+}
+
+void printTdrStatus(void)
+{
+	printf("Tdr Mode %d Window %d Sent %n Skipped %n\r\n", tdrMode, tdrWindow,
+			tdrSent, tdrSkipped);
+}
@@ -0,0 +1,60 @@
+/*
+ * tdr.h
+ *
+ * Time domain transform of S11 for finding faults down a cable.  With
+ * "O mode window" on and binary output, every complete sweep that is
+ * streamed is followed by a STREAM_TDR frame holding the inverse FFT of
+ * its S11, TDR_FFT_SIZE points long:
+ *
+ *   STREAM_SYNC, STREAM_TDR, seq(4), mode(1), numBins(2), binPicoseconds(4),
+ *   value(2) * numBins
+ *
+ * Band pass works with any plan of up to TDR_MAX_BANDPASS_POINTS points
+ * and gives the magnitude of the impulse response.  Low pass needs a plan
+ * whose frequencies are all harmonics of the first (start = step), of up
+ * to TDR_MAX_LOWPASS_POINTS points; S11 at DC is extrapolated from the
+ * first two points and the spectrum mirrored, so the impulse response is
+ * real and signed, and the host can sum it for the step response.  Bin n
+ * is n * binPicoseconds after the reference plane, out and back, and the
+ * response repeats every numBins bins.
+ *
+ * Values are Q14 and scaled by the window's gain, so a short at the end
+ * of a lossless line reads -1 at its bin.  Uncorrected sweeps are taken
+ * as raw readings over ADC full scale, which only shows where things are.
+ *
+ * The window is rectangular, Hann or Blackman, centred on the band for
+ * band pass and on DC for low pass.  The twiddles and window come from one
+ * sine table in flash, so nothing is worked out when the plan changes.
+ */
+
+#ifndef TDR_H_
+#define TDR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TDR_FFT_BITS	9
+#define TDR_FFT_SIZE	(1 << TDR_FFT_BITS)
+#define TDR_MAX_BANDPASS_POINTS	TDR_FFT_SIZE
+#define TDR_MAX_LOWPASS_POINTS	(TDR_FFT_SIZE / 2 - 1)
+
+typedef enum {
+	TDR_OFF = 0,
+	TDR_BANDPASS = 1,
+	TDR_LOWPASS = 2
+} TdrMode;
+
+typedef enum {
+	TDR_RECTANGULAR = 0,
+	TDR_HANN = 1,
+	TDR_BLACKMAN = 2
+} TdrWindow;
+
+void setTdr(TdrMode mode, TdrWindow window);
+void getTdr(TdrMode *mode, TdrWindow *window);
+void tdrBeginSweep(uint32_t seq, bool corrected);
+void tdrPoint(uint16_t index, const uint16_t *results);
+void tdrEndSweep(bool complete);
+void printTdrStatus(void);
+
+#endif /* TDR_H_ */
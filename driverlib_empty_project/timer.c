@@ -0,0 +1,55 @@
+/*
+ * timer.c
+ *
+ * See timer.h.  Timer32 counts down, so the ticks are the complement of
+ * the counter value.  At 3 MHz the 32 bit count wraps after about 23
+ * minutes, which is far longer than any wait.  initializeTimer() must be
+ * called again if MCLK changes.
+ */
+
+/* DriverLib Includes */
+#include "driverlib.h"
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "timer.h"
+
+static uint32_t timerHz;
+
+void initializeTimer(void)
+{
+	timerHz = CS_getMCLK();
+	MAP_Timer32_initModule(TIMER32_0_BASE, TIMER32_PRESCALER_1, TIMER32_32BIT,
+			TIMER32_FREE_RUN_MODE);
+	MAP_Timer32_startTimer(TIMER32_0_BASE, false);
+}
+
+uint32_t timerTicks(void)
+{
+	return ~MAP_Timer32_getValue(TIMER32_0_BASE);
+}
+
+uint32_t microsecondsToTicks(uint32_t microseconds)
+{
+	return (uint32_t)((uint64_t)microseconds * timerHz / 1000000);
+}
+
+uint32_t ticksToMicroseconds(uint32_t ticks)
+{
+	return timerHz ? (uint32_t)((uint64_t)ticks * 1000000 / timerHz) : 0;
+}
+
+bool timerElapsed(uint32_t start, uint32_t ticks)
+{
+	return timerTicks() - start >= ticks;
+}
+
+void delayMicroseconds(uint32_t microseconds)
+{
+	uint32_t start = timerTicks();
+	uint32_t ticks = microsecondsToTicks(microseconds);
+
+	while(!timerElapsed(start, ticks));
+}
@@ -0,0 +1,23 @@
+/*
+ * timer.h
+ *
+ * Free running time base on Timer32 module 0, clocked from MCLK with no
+ * prescaler.  Code that has to wait, or give up waiting, takes a start
+ * time from timerTicks() and polls timerElapsed(); nothing else uses the
+ * timer, so any number of waits can run at once.
+ */
+
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void initializeTimer(void);
+uint32_t timerTicks(void);
+uint32_t microsecondsToTicks(uint32_t microseconds);
+uint32_t ticksToMicroseconds(uint32_t ticks);
+bool timerElapsed(uint32_t start, uint32_t ticks);
+void delayMicroseconds(uint32_t microseconds);
+
+#endif /* TIMER_H_ */
@@ -0,0 +1,149 @@
+/*
+ * trace.c
+ *
+ * Storage and reporting for the tracepoints in trace.h.  traceRecord() is
+ * called from interrupt handlers as well as the main loop; every
+ * tracepoint is only ever recorded from one context, so the statistics
+ * need no locking.
+ */
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef TRACE_HOST
+#include <time.h>
+#else
+/* DriverLib Includes */
+#include "driverlib.h"
+#endif
+
+#include "stream.h"
+#include "trace.h"
+
+TraceStats traceStats[NUM_TRACEPOINTS];
+volatile uint32_t traceStart[NUM_TRACEPOINTS];
+
+#ifdef TRACE_HOST
+uint32_t traceHostCycles(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)((uint64_t)now.tv_sec * TRACE_HOST_HZ +
+			(uint64_t)now.tv_nsec * (TRACE_HOST_HZ / 1000000) / 1000);
+}
+#endif
+
+void clearTrace(void)
+{
+	int i, j;
+
+	for(i = 0; i < NUM_TRACEPOINTS; i++)
+	{
+		traceStats[i].count = 0;
+		traceStats[i].minCycles = 0xFFFFFFFF;
+		traceStats[i].maxCycles = 0;
+		traceStats[i].totalCycles = 0;
+		for(j = 0; j < TRACE_HISTOGRAM_BUCKETS; j++)
+			traceStats[i].histogram[j] = 0;
+	}
+}
+
+/*
+ * Start the DWT cycle counter.  It is only 32 bits, so at 48 MHz a single
+ * traced interval must be under about 89 seconds.
+ */
+void initializeTrace(void)
+{
+#ifndef TRACE_HOST
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	clearTrace();
+}
+
+uint32_t traceClockHz(void)
+{
+#ifdef TRACE_HOST
+	return TRACE_HOST_HZ;
+#else
+	return CS_getMCLK();
+#endif
+}
+
+#pragma CODE_SECTION(traceRecord, ".sramcode")
+void traceRecord(Tracepoint tracepoint, uint32_t cycles)
+{
+	TraceStats *stats = &traceStats[tracepoint];
+	uint32_t scaled = cycles >> 1;
+	int bucket = 0;
+
+	stats->count++;
+	stats->totalCycles += cycles;
+	if(cycles < stats->minCycles)
+		stats->minCycles = cycles;
+	if(cycles > stats->maxCycles)
+		stats->maxCycles = cycles;
+
+	while(scaled && (bucket < TRACE_HISTOGRAM_BUCKETS - 1))
+	{
+		scaled >>= 1;
+		bucket++;
+	}
+	if(stats->histogram[bucket] != 0xFFFF)
+		stats->histogram[bucket]++;
+}
+
+static uint8_t *put16(uint8_t *p, uint16_t value)
+{
+	*p++ = (uint8_t)value;
+	*p++ = (uint8_t)(value >> 8);
+	return p;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t value)
+{
+	p = put16(p, (uint16_t)value);
+	return put16(p, (uint16_t)(value >> 16));
+}
+
+/*
+ * Build the binary trace report, little endian:
+ *
+ *   STREAM_SYNC, STREAM_TRACE_REPORT, length(2), clockHz(4), numTracepoints(1)
+ *   then for each tracepoint:
+ *   id(1), count(4), min(4), max(4), mean(4), histogram(2 * TRACE_HISTOGRAM_BUCKETS)
+ *
+ * length counts the bytes after the length field.  Returns the number of
+ * bytes written, or 0 if the buffer is too small.
+ */
+uint16_t traceReport(uint8_t *buffer, uint16_t size)
+{
+	uint8_t *p = buffer;
+	TraceStats *stats;
+	int i, j;
+
+	if(size < TRACE_REPORT_BYTES)
+		return 0;
+
+	*p++ = STREAM_SYNC;
+	*p++ = STREAM_TRACE_REPORT;
+	p = put16(p, TRACE_REPORT_BYTES - 4);
+	p = put32(p, traceClockHz());
+	*p++ = NUM_TRACEPOINTS;
+
+	for(i = 0; i < NUM_TRACEPOINTS; i++)
+	{
+		stats = &traceStats[i];
+		*p++ = (uint8_t)i;
+		p = put32(p, stats->count);
+		p = put32(p, stats->count ? stats->minCycles : 0);
+		p = put32(p, stats->maxCycles);
+		p = put32(p, stats->count ? (uint32_t)(stats->totalCycles / stats->count) : 0);
+		for(j = 0; j < TRACE_HISTOGRAM_BUCKETS; j++)
+			p = put16(p, stats->histogram[j]);
+	}
+	return TRACE_REPORT_BYTES;
+}
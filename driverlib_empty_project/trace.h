@@ -0,0 +1,81 @@
+/*
+ * trace.h
+ *
+ * Cycle counting tracepoints for the hot path.  Each tracepoint keeps a
+ * count, min, max and running total of the cycles between TRACE_BEGIN
+ * and TRACE_END, plus a log2 histogram, all in RAM.  The 'T' command
+ * sends them to the host as one STREAM_TRACE_REPORT frame (see stream.h).
+ *
+ * On the MSP432 the cycles come from the Cortex-M4 DWT cycle counter, so
+ * they are MCLK cycles.  Define TRACE_HOST to build trace.c on a PC; the
+ * counter is then a monotonic clock scaled to TRACE_HOST_HZ.
+ *
+ * Comment out ENABLE_TRACE to compile every tracepoint away.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ENABLE_TRACE
+
+#define TRACE_HISTOGRAM_BUCKETS	16	/* Bucket n counts 2^n to 2^(n+1)-1 cycles. */
+#define TRACE_HOST_HZ			48000000
+
+typedef enum {
+	TRACE_SWEEP_POINT,			/* Whole point, frequency change to output. */
+	TRACE_SET_DDS_FREQUENCY,
+	TRACE_UPDATE_VERSACLOCK_REGS,
+	TRACE_WRITE_VERSACLOCK_BLOCK,
+	TRACE_ADC_CONVERSION,		/* Trigger until the results are back. */
+	TRACE_ADC14_ISR,
+	TRACE_EUSCIB1_ISR,
+	TRACE_EUSCIA0_ISR,
+	TRACE_STREAM_POINT,			/* Formatting and queueing one point. */
+	TRACE_TDR_TRANSFORM,		/* Window, inverse FFT and framing, per sweep. */
+	TRACE_CORRECT_POINT,		/* Quadrature and S11 error correction. */
+	NUM_TRACEPOINTS
+} Tracepoint;
+
+typedef struct TraceStats {
+	uint32_t count;
+	uint32_t minCycles;
+	uint32_t maxCycles;
+	uint64_t totalCycles;
+	uint16_t histogram[TRACE_HISTOGRAM_BUCKETS];
+} TraceStats;
+
+/* Bytes in the report built by traceReport(). */
+#define TRACE_REPORT_HEADER_BYTES	9
+#define TRACE_REPORT_ENTRY_BYTES	(17 + 2 * TRACE_HISTOGRAM_BUCKETS)
+#define TRACE_REPORT_BYTES	(TRACE_REPORT_HEADER_BYTES + \
+		NUM_TRACEPOINTS * TRACE_REPORT_ENTRY_BYTES)
+
+extern TraceStats traceStats[NUM_TRACEPOINTS];
+extern volatile uint32_t traceStart[NUM_TRACEPOINTS];
+
+#ifdef TRACE_HOST
+uint32_t traceHostCycles(void);
+#define TRACE_CYCLES()	traceHostCycles()
+#else
+#include "msp432.h"
+#define TRACE_CYCLES()	(DWT->CYCCNT)
+#endif
+
+void initializeTrace(void);
+void clearTrace(void);
+uint32_t traceClockHz(void);
+void traceRecord(Tracepoint tracepoint, uint32_t cycles);
+uint16_t traceReport(uint8_t *buffer, uint16_t size);
+
+#ifdef ENABLE_TRACE
+#define TRACE_BEGIN(tracepoint)	(traceStart[tracepoint] = TRACE_CYCLES())
+#define TRACE_END(tracepoint)	traceRecord(tracepoint, TRACE_CYCLES() - traceStart[tracepoint])
+#else
+#define TRACE_BEGIN(tracepoint)
+#define TRACE_END(tracepoint)
+#endif
+
+#endif /* TRACE_H_ */
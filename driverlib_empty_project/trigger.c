@@ -0,0 +1,91 @@
+/*
+ * trigger.c
+ *
+ * The line is polled through its port interrupt flag rather than taking
+ * the interrupt; the sweep only looks at it between sweeps anyway.
+ */
+
+/* DriverLib Includes */
+#include "driverlib.h"
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "printf.h"
+#include "timer.h"
+#include "trigger.h"
+
+#define TRIGGER_PORT	GPIO_PORT_P3
+#define TRIGGER_PIN		GPIO_PIN6
+
+#define DIE_RECORD_WORDS	4	/* X, Y, wafer and lot. */
+
+static TriggerMode triggerMode;
+static uint32_t triggeredSweeps;
+
+void initializeTrigger(void)
+{
+	setTriggerMode(TRIGGER_FREE);
+}
+
+void setTriggerMode(TriggerMode mode)
+{
+	triggerMode = mode;
+	if(mode == TRIGGER_LEAD)
+	{
+		MAP_GPIO_setOutputLowOnPin(TRIGGER_PORT, TRIGGER_PIN);
+		MAP_GPIO_setAsOutputPin(TRIGGER_PORT, TRIGGER_PIN);
+	}
+	else
+	{
+		/* Pulled down so a follower with nothing connected just waits.
+		 * Choosing the edge can set the flag, so clear it after. */
+		MAP_GPIO_setAsInputPinWithPullDownResistor(TRIGGER_PORT, TRIGGER_PIN);
+		MAP_GPIO_interruptEdgeSelect(TRIGGER_PORT, TRIGGER_PIN,
+				GPIO_LOW_TO_HIGH_TRANSITION);
+		MAP_GPIO_clearInterruptFlag(TRIGGER_PORT, TRIGGER_PIN);
+	}
+}
+
+TriggerMode getTriggerMode(void)
+{
+	return triggerMode;
+}
+
+/*
+ * Called before the first point of each sweep.  Returns false if the
+ * sweep has to wait for its edge.
+ */
+bool triggerSweep(void)
+{
+	switch(triggerMode)
+	{
+	case TRIGGER_FOLLOW:
+		if(!MAP_GPIO_getInterruptStatus(TRIGGER_PORT, TRIGGER_PIN))
+			return false;
+		MAP_GPIO_clearInterruptFlag(TRIGGER_PORT, TRIGGER_PIN);
+		break;
+	case TRIGGER_LEAD:
+		MAP_GPIO_setOutputHighOnPin(TRIGGER_PORT, TRIGGER_PIN);
+		delayMicroseconds(TRIGGER_PULSE_US);
+		MAP_GPIO_setOutputLowOnPin(TRIGGER_PORT, TRIGGER_PIN);
+		break;
+	default:
+		return true;
+	}
+	triggeredSweeps++;
+	return true;
+}
+
+void printTriggerStatus(void)
+{
+	uint32_t length, i;
+	uint32_t *dieRecord;
+
+	MAP_SysCtl_getTLVInfo(TLV_TAG_DIEREC, 0, &length, &dieRecord);
+	printf("Device");
+	for(i = 0; (i < DIE_RECORD_WORDS) && (i < length); i++)
+		printf(" %n", dieRecord[i]);
+	printf(" Trigger %d Triggered %n\r\n", triggerMode, triggeredSweeps);
+}
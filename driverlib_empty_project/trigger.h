@@ -0,0 +1,42 @@
+/*
+ * trigger.h
+ *
+ * Sweep start trigger, so a rack of boards can sweep in step.  The boards
+ * share one line on P3.6 and one of them leads:
+ *
+ *   TRIGGER_FREE    Each sweep starts as soon as the last one ends (the
+ *                   default).  The line is an input and ignored.
+ *   TRIGGER_FOLLOW  Each sweep waits for a rising edge on the line.
+ *   TRIGGER_LEAD    The line is driven, with a TRIGGER_PULSE_US pulse at
+ *                   the start of each sweep.
+ *
+ * The edge is latched by the port, so a follower does not miss it while a
+ * command runs, but it only remembers one: a follower whose own sweep
+ * takes longer than the leader's starts on the next edge after it
+ * finishes.  Give followers the same plan or a shorter one.
+ *
+ * The die record from the TLV identifies the board, so a host talking to
+ * several can tell which port is which.
+ */
+
+#ifndef TRIGGER_H_
+#define TRIGGER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TRIGGER_PULSE_US	10
+
+typedef enum {
+	TRIGGER_FREE = 0,
+	TRIGGER_FOLLOW = 1,
+	TRIGGER_LEAD = 2
+} TriggerMode;
+
+void initializeTrigger(void);
+void setTriggerMode(TriggerMode mode);
+TriggerMode getTriggerMode(void);
+bool triggerSweep(void);
+void printTriggerStatus(void);
+
+#endif /* TRIGGER_H_ */
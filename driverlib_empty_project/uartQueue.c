@@ -0,0 +1,181 @@
+/*
+ * uartQueue.c
+ *
+ * Ring buffers between the main loop and the backchannel UART (eUSCI A0).
+ * There is one producer and one consumer per ring, so the head and tail
+ * indices only need to be volatile; no interrupt locking is required.
+ *
+ * In blocking mode (the default, and what the boot messages use) a full
+ * transmit queue makes the caller wait for the ISR to drain it, the same
+ * as the old polled sendByte.  In non-blocking mode, used while streaming
+ * under host flow control, the bytes are dropped and counted instead so
+ * that the measurement loop never stalls on the serial link.
+ *
+ * Sink mode counts and discards everything written, so the benchmarks
+ * can time the output code without waiting on the wire.
+ */
+
+/* DriverLib Includes */
+#include "driverlib.h"
+
+/* Standard Includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "uartQueue.h"
+#include "trace.h"
+
+#define TX_MASK (UART_TX_QUEUE_SIZE - 1)
+#define RX_MASK (UART_RX_QUEUE_SIZE - 1)
+
+static uint8_t txQueue[UART_TX_QUEUE_SIZE];
+static volatile uint16_t txHead;	/* Written by the main loop. */
+static volatile uint16_t txTail;	/* Written by the ISR. */
+static uint8_t rxQueue[UART_RX_QUEUE_SIZE];
+static volatile uint16_t rxHead;	/* Written by the ISR. */
+static volatile uint16_t rxTail;	/* Written by the main loop. */
+static bool txBlocking = true;
+static bool txSink;
+
+volatile uint32_t uartTxOverruns;
+volatile uint32_t uartRxOverruns;
+uint32_t uartSinkBytes;
+
+/*
+ * USCIA0 interrupt handler for backchannel UART.
+ * For interrupts, don't forget to edit the startup...c file!
+ */
+#pragma CODE_SECTION(EusciA0_ISR, ".sramcode")
+void EusciA0_ISR(void)
+{
+	uint16_t head;
+
+	TRACE_BEGIN(TRACE_EUSCIA0_ISR);
+	if(UCA0IFG & UCRXIFG)
+	{
+		uint8_t receiveByte = UCA0RXBUF; /* Reading clears the flag. */
+		head = rxHead;
+		if(((head + 1) & RX_MASK) != rxTail)
+		{
+			rxQueue[head] = receiveByte;
+			rxHead = (head + 1) & RX_MASK;
+		}
+		else
+			uartRxOverruns++;
+	}
+
+	if((UCA0IE & UCTXIE) && (UCA0IFG & UCTXIFG))
+	{
+		if(txTail != txHead)
+		{
+			UCA0TXBUF = txQueue[txTail];
+			txTail = (txTail + 1) & TX_MASK;
+		}
+		else
+			UCA0IE &= ~UCTXIE; /* Nothing left to send. */
+	}
+	TRACE_END(TRACE_EUSCIA0_ISR);
+}
+
+void initializeUartQueue(void)
+{
+	txHead = txTail = 0;
+	rxHead = rxTail = 0;
+	uartTxOverruns = 0;
+	uartRxOverruns = 0;
+	txBlocking = true;
+}
+
+void uartQueueSetBlocking(bool blocking)
+{
+	txBlocking = blocking;
+}
+
+void uartQueueSetSink(bool sink)
+{
+	txSink = sink;
+	uartSinkBytes = 0;
+}
+
+uint16_t uartQueueFree(void)
+{
+	if(txSink)
+		return UART_TX_QUEUE_SIZE - 1;
+	return (UART_TX_QUEUE_SIZE - 1) - ((txHead - txTail) & TX_MASK);
+}
+
+bool uartQueueEmpty(void)
+{
+	return txHead == txTail;
+}
+
+#pragma CODE_SECTION(uartQueuePut, ".sramcode")
+bool uartQueuePut(uint8_t c)
+{
+	uint16_t head = txHead;
+	uint16_t next = (head + 1) & TX_MASK;
+
+	if(txSink)
+	{
+		uartSinkBytes++;
+		return true;
+	}
+	while(next == txTail)
+	{
+		if(!txBlocking)
+		{
+			uartTxOverruns++;
+			return false;
+		}
+	}
+	txQueue[head] = c;
+	txHead = next;
+	UCA0IE |= UCTXIE; /* TXIFG is already set when idle, so this kicks the ISR. */
+	return true;
+}
+
+/*
+ * Queue a whole record or none of it, so a full queue never leaves half a
+ * frame on the wire.
+ */
+#pragma CODE_SECTION(uartQueueWrite, ".sramcode")
+bool uartQueueWrite(const uint8_t *data, uint16_t numBytes)
+{
+	uint16_t head, i;
+
+	if(txSink)
+	{
+		uartSinkBytes += numBytes;
+		return true;
+	}
+	if(numBytes > UART_TX_QUEUE_SIZE - 1)
+		return false;
+	while(uartQueueFree() < numBytes)
+	{
+		if(!txBlocking)
+		{
+			uartTxOverruns += numBytes;
+			return false;
+		}
+	}
+	head = txHead;
+	for(i = 0; i < numBytes; i++)
+	{
+		txQueue[head] = data[i];
+		head = (head + 1) & TX_MASK;
+	}
+	txHead = head;
+	UCA0IE |= UCTXIE;
+	return true;
+}
+
+bool uartQueueGet(uint8_t *c)
+{
+	uint16_t tail = rxTail;
+
+	if(tail == rxHead)
+		return false;
+	*c = rxQueue[tail];
+	rxTail = (tail + 1) & RX_MASK;
+	return true;
+}
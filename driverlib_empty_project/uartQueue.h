@@ -0,0 +1,36 @@
+/*
+ * uartQueue.h
+ *
+ * Interrupt driven transmit and receive queues for the backchannel UART.
+ * The sweep code writes into the transmit queue and goes straight back
+ * to measuring; EusciA0_ISR drains the queue one byte per TX interrupt.
+ */
+
+#ifndef UARTQUEUE_H_
+#define UARTQUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Both sizes must be powers of two. */
+#define UART_TX_QUEUE_SIZE	2048
+#define UART_RX_QUEUE_SIZE	64
+
+/* Bytes thrown away because the transmit queue was full in non-blocking
+ * mode, and received bytes lost because the command parser fell behind. */
+extern volatile uint32_t uartTxOverruns;
+extern volatile uint32_t uartRxOverruns;
+
+/* Bytes swallowed while the queue is in sink mode. */
+extern uint32_t uartSinkBytes;
+
+void initializeUartQueue(void);
+void uartQueueSetBlocking(bool blocking);
+void uartQueueSetSink(bool sink);
+bool uartQueuePut(uint8_t c);
+bool uartQueueWrite(const uint8_t *data, uint16_t numBytes);
+uint16_t uartQueueFree(void);
+bool uartQueueEmpty(void);
+bool uartQueueGet(uint8_t *c);
+
+#endif /* UARTQUEUE_H_ */
@@ -0,0 +1,78 @@
+/*
+ * vna.h
+ *
+ * Hardware routines from main.c that the sweep, stream and command code
+ * call into.
+ */
+
+#ifndef VNA_H_
+#define VNA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "busModel.h"
+
+#define NUM_ADC14_CHANNELS 4
+
+/* Order of the channels in resultsBuffer, set by the ADC_MEM0-3 setup. */
+#define ADC_S11_RE	0	/* A0 */
+#define ADC_S11_IM	1	/* A1 */
+#define ADC_S21_RE	2	/* A8 */
+#define ADC_S21_IM	3	/* A6 */
+
+/* 14 bit conversions. */
+#define ADC_MIDSCALE	8192
+#define ADC_FULL_SCALE	16383
+
+#define NUM_BANDS 8		/* VersaClock bands, see PllClockRegisters. */
+
+/* The DDS covers 1 MHz to 70 MHz. */
+#define MIN_FREQUENCY	1000000L
+#define MAX_FREQUENCY	70000000L
+
+#define ADC_TIMEOUT_US	1000	/* A four channel sequence takes about 30 us. */
+
+/* updateVersaclockRegs() results */
+#define VERSACLOCK_OK			0
+#define VERSACLOCK_NO_BAND		1
+#define VERSACLOCK_BUS_FAULT	2
+
+/* VersaClock I2C error counters, reported by the ? command. */
+typedef struct I2CCounters {
+	uint32_t naks;
+	uint32_t timeouts;
+	uint32_t retries;
+	uint32_t recoveries;	/* SCL clocked by hand to free the bus. */
+	uint32_t failures;		/* Transactions given up on. */
+	uint32_t mismatches;	/* Readback differed from what was written. */
+} I2CCounters;
+
+extern I2CCounters i2cCounters;
+extern uint16_t resultsBuffer[NUM_ADC14_CHANNELS];
+extern volatile bool adcResultsReady;
+
+/* Forward Declaration of Functions */
+void initializeClocks(void);
+int initializeBackChannelUART(void);
+int initializeADC(void);
+int initializeDDS(void);
+int initializeVersaclock(void);
+int initializeI2C(void);
+int updateVersaclockRegs(long int frequency);
+int versaclockBand(long int frequency);
+void initializeBusConfig(BusConfig *config);
+bool dumpI2C(void);
+void printI2CStatus(void);
+void setVersaclockVerify(bool verify);
+bool getVersaclockVerify(void);
+bool initCDCE(void);
+bool writeVersaClockBlock(const uint8_t *firstDataPtr ,uint8_t blockStart, uint8_t numBytes);
+int setDDSFrequency(long long frequency);
+int readADC(uint16_t *results);
+void pulseFQ_UD(void);
+void pulse_W_CLK(void);
+void pulse_DDS_RST(void);
+void initI2C(void);
+
+#endif /* VNA_H_ */
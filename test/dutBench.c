@@ -0,0 +1,74 @@
+/*
+ * dutBench.c
+ *
+ * Host throughput of the DUT model in dutModel.c, built as it is for the
+ * firmware.  Sweeps every DUT from 1 to 100 MHz, tuning once per
+ * frequency and reading the ADC readsPerPoint times there as averaging
+ * would, and prints points per second for each.  See the Makefile.
+ */
+
+#define _POSIX_C_SOURCE	199309L		/* clock_gettime() under -std=c99 */
+
+/* printf.h declares printf() the way the firmware's own printf.c does,
+ * which clashes with the host's.  dutModel.c only prints its status. */
+#define printf dutPrintf
+#include "../driverlib_empty_project/dutModel.c"
+#undef printf
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_POINTS		1000000L
+#define BENCH_START			1000000L	/* Hz */
+#define BENCH_STOP			100000000L
+
+void dutPrintf(char *format, ...)
+{
+	(void)format;
+}
+
+static double seconds(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/* Points per second tuning every point and reading it readsPerPoint times. */
+static double run(DutType dut, int readsPerPoint, uint32_t *checksum)
+{
+	uint16_t results[NUM_ADC14_CHANNELS];
+	double start;
+	long i;
+	int r;
+
+	dutModelSelect(dut, DUT_DEFAULT_NOISE);
+	start = seconds();
+	for(i = 0; i < BENCH_POINTS; i++)
+	{
+		dutModelTune(BENCH_START + (BENCH_STOP - BENCH_START) / BENCH_POINTS * i);
+		for(r = 0; r < readsPerPoint; r++)
+		{
+			dutModelRead(results);
+			*checksum += results[0] + results[3];
+		}
+	}
+	return BENCH_POINTS / (seconds() - start);
+}
+
+int main(void)
+{
+	static const char *const names[NUM_DUTS] = {
+		"Thru", "Open", "Short", "Crystal", "Resonator", "Line", "OpenLine", "Lowpass"
+	};
+	uint32_t checksum = 0;
+	int dut;
+
+	printf("Dut,PointsPerSec,PointsPerSecAveraged16\n");
+	for(dut = 0; dut < NUM_DUTS; dut++)
+		printf("%s,%.0f,%.0f\n", names[dut], run((DutType)dut, 1, &checksum),
+				run((DutType)dut, 16, &checksum));
+	printf("Checksum %u\n", checksum);
+	return 0;
+}
@@ -0,0 +1,264 @@
+/*
+ * solTest.c
+ *
+ * Host golden test of the SOL correction in sol.c against a double
+ * precision reference.  Builds sol.c as it is, with its plain C
+ * arithmetic (the M4F DSP path computes the same values), and stubs what
+ * it needs from the rest of the firmware.  See the Makefile.
+ *
+ * For random error terms, and for each ideal standard, the three
+ * standards are "measured" through the one-port model and rounded to ADC
+ * counts as the sweep would capture them.  solComputeTerms() must then
+ * match the double precision solution of the same captures to within
+ * TERMS_TOLERANCE LSB.  Random reflection coefficients, and the
+ * standards themselves, are then measured the same way and solPoint()
+ * must match the double precision correction, with the fixed point terms
+ * it was given, to within POINT_TOLERANCE LSB of Q14.
+ */
+
+/* printf.h declares printf() the way the firmware's own printf.c does,
+ * which clashes with the host's.  sol.c only prints its status. */
+#define printf solPrintf
+#include "../driverlib_empty_project/sol.c"
+#undef printf
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define NUM_TERM_SETS		2000
+#define POINTS_PER_SET		50
+#define TERMS_TOLERANCE		1	/* LSB of the Q15 match and counts of tracking. */
+/* LSB of the Q14 result.  solPoint() truncates the denominator to whole
+ * counts, up to 1 in each part, and |den| = |e10e01 / (1 - e11 G)| is at
+ * least 1500 / 1.3 here, so at |G| = 1 that alone is up to
+ * 16384 * 1.42 / 1154, about 20 LSB.  The reciprocal and the final shift
+ * add one or two more. */
+#define POINT_TOLERANCE		24
+
+/* Stubs for what sol.c uses from the rest of the firmware. */
+SweepPlan sweepPlan;
+const CalPage *activeCal;
+static CalPage testCal;
+
+void solPrintf(char *format, ...)
+{
+	(void)format;
+}
+
+bool samePlan(const SweepPlan *a, const SweepPlan *b)
+{
+	return (a->startFrequency == b->startFrequency) &&
+			(a->stopFrequency == b->stopFrequency) && (a->numPoints == b->numPoints);
+}
+
+long int sweepPointFrequency(uint16_t index)
+{
+	return sweepPlan.startFrequency + index;
+}
+
+bool adaptiveRefined(void)
+{
+	return false;
+}
+
+CalPage *calEditPage(void)
+{
+	return &testCal;
+}
+
+typedef struct Cplx {
+	double re;
+	double im;
+} Cplx;
+
+static Cplx cplx(double re, double im)
+{
+	Cplx c;
+
+	c.re = re;
+	c.im = im;
+	return c;
+}
+
+static Cplx cadd(Cplx a, Cplx b)
+{
+	return cplx(a.re + b.re, a.im + b.im);
+}
+
+static Cplx csub(Cplx a, Cplx b)
+{
+	return cplx(a.re - b.re, a.im - b.im);
+}
+
+static Cplx cmul(Cplx a, Cplx b)
+{
+	return cplx(a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re);
+}
+
+static Cplx cdiv(Cplx a, Cplx b)
+{
+	double mag2 = b.re * b.re + b.im * b.im;
+
+	return cplx((a.re * b.re + a.im * b.im) / mag2, (a.im * b.re - a.re * b.im) / mag2);
+}
+
+static uint32_t randomState = 0x2545F491;
+
+/* Uniform in [low, high). */
+static double uniform(double low, double high)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return low + (high - low) * (randomState / 4294967296.0);
+}
+
+static Cplx randomPolar(double low, double high)
+{
+	double magnitude = uniform(low, high), angle = uniform(0.0, 6.283185307179586);
+
+	return cplx(magnitude * cos(angle), magnitude * sin(angle));
+}
+
+/* The raw reading, about midscale, for reflection g through the terms. */
+static Cplx measure(Cplx e00, Cplx e11, Cplx e10e01, Cplx g)
+{
+	return cadd(e00, cdiv(cmul(e10e01, g), csub(cplx(1.0, 0.0), cmul(e11, g))));
+}
+
+static CalComplex toCounts(Cplx m)
+{
+	CalComplex c;
+
+	c.re = (int16_t)lrint(m.re);
+	c.im = (int16_t)lrint(m.im);
+	return c;
+}
+
+static Cplx fromCal(CalComplex c, double scale)
+{
+	return cplx(c.re / scale, c.im / scale);
+}
+
+static int worstTerms, worstPoint;
+static long failures;
+
+static void check(const char *what, double expected, int actual, int tolerance, int *worst)
+{
+	int error;
+
+	if(expected > 32767.0)
+		expected = 32767.0;
+	else if(expected < -32768.0)
+		expected = -32768.0;
+	error = (int)lrint(fabs(expected - actual));
+	if(error > *worst)
+		*worst = error;
+	if(error > tolerance)
+	{
+		if(failures < 10)
+			fprintf(stderr, "%s: expected %.2f got %d\n", what, expected, actual);
+		failures++;
+	}
+}
+
+/* solComputeTerms() on one set of captures against the double solution. */
+static bool checkTerms(const CalTerms *terms)
+{
+	Cplx load = fromCal(captures[SOL_LOAD][0], 1.0);
+	Cplx a = csub(fromCal(captures[SOL_OPEN][0], 1.0), load);
+	Cplx b = csub(fromCal(captures[SOL_SHORT][0], 1.0), load);
+	Cplx e11, e10e01;
+
+	if((a.re == b.re) && (a.im == b.im))
+		return false;
+	e11 = cdiv(cadd(a, b), csub(a, b));
+	e10e01 = cdiv(cmul(cplx(-2.0, 0.0), cmul(a, b)), csub(a, b));
+	check("directivity re", load.re, terms->directivity.re, 0, &worstTerms);
+	check("directivity im", load.im, terms->directivity.im, 0, &worstTerms);
+	check("source match re", e11.re * 32768.0, terms->sourceMatch.re, TERMS_TOLERANCE, &worstTerms);
+	check("source match im", e11.im * 32768.0, terms->sourceMatch.im, TERMS_TOLERANCE, &worstTerms);
+	check("tracking re", e10e01.re, terms->tracking.re, TERMS_TOLERANCE, &worstTerms);
+	check("tracking im", e10e01.im, terms->tracking.im, TERMS_TOLERANCE, &worstTerms);
+	return true;
+}
+
+/* solPoint() on reading m against the double correction with terms.
+ * Returns false if the reading is off the ADC's scale or the correction
+ * off the Q14 scale, so not checked. */
+static bool checkPoint(const CalTerms *terms, CalComplex m)
+{
+	Cplx e00 = fromCal(terms->directivity, 1.0);
+	Cplx e11 = fromCal(terms->sourceMatch, 32768.0);
+	Cplx e10e01 = fromCal(terms->tracking, 1.0);
+	Cplx d = csub(fromCal(m, 1.0), e00), den, g;
+	uint16_t results[NUM_ADC14_CHANNELS];
+	int32_t reading;
+
+	reading = m.re + ADC_MIDSCALE;
+	if((reading < 0) | (reading > ADC_FULL_SCALE))
+		return false;
+	reading = m.im + ADC_MIDSCALE;
+	if((reading < 0) | (reading > ADC_FULL_SCALE))
+		return false;
+	results[ADC_S11_RE] = (uint16_t)(m.re + ADC_MIDSCALE);
+	results[ADC_S11_IM] = (uint16_t)(m.im + ADC_MIDSCALE);
+	pointTerms = terms;
+	solPoint(0, results);
+
+	den = cadd(e10e01, cmul(e11, d));
+	if(den.re * den.re + den.im * den.im < SOL_MIN_MAG2)
+		return false;	/* solPoint() saturates. */
+	g = cdiv(d, den);
+	check("point re", g.re * 16384.0, (int)results[ADC_S11_RE] - SOL_OUTPUT_OFFSET,
+			POINT_TOLERANCE, &worstPoint);
+	check("point im", g.im * 16384.0, (int)results[ADC_S11_IM] - SOL_OUTPUT_OFFSET,
+			POINT_TOLERANCE, &worstPoint);
+	return true;
+}
+
+static long sets, points;
+
+/* Capture the standards through one set of terms, solve, and correct the
+ * standards and numPoints random reflections with the result. */
+static void runSet(Cplx e00, Cplx e11, Cplx e10e01, int numPoints)
+{
+	const Cplx ideal[SOL_NUM_STANDARDS] = {{-1.0, 0.0}, {1.0, 0.0}, {0.0, 0.0}};
+	int s, p;
+
+	for(s = 0; s < SOL_NUM_STANDARDS; s++)
+		captures[s][0] = toCounts(measure(e00, e11, e10e01, ideal[s]));
+	capturePlan.numPoints = 1;
+	capturedMask = SOL_ALL_CAPTURED;
+	if(!solComputeTerms() || !checkTerms(&testCal.sol[0]))
+		return;
+	sets++;
+	for(s = 0; s < SOL_NUM_STANDARDS; s++)
+		points += checkPoint(&testCal.sol[0], captures[s][0]);
+	for(p = 0; p < numPoints; p++)
+		points += checkPoint(&testCal.sol[0], toCounts(measure(e00, e11, e10e01,
+				randomPolar(0.0, 1.0))));
+}
+
+int main(void)
+{
+	int set;
+
+	/* Standard cases: a perfect front end, one with only tracking, and
+	 * the front end dutModel.c simulates at 10 MHz. */
+	runSet(cplx(0.0, 0.0), cplx(0.0, 0.0), cplx(6000.0, 0.0), POINTS_PER_SET);
+	runSet(cplx(0.0, 0.0), cplx(0.0, 0.0), cplx(0.0, -3000.0), POINTS_PER_SET);
+	runSet(cplx(119.9, -3.8), cplx(0.0491, -0.0094), cplx(5893.7, -1124.3), POINTS_PER_SET);
+
+	/* Roughly what the front end gives: a little directivity, a modest
+	 * source match and a few thousand counts of tracking. */
+	for(set = 0; set < NUM_TERM_SETS; set++)
+		runSet(randomPolar(0.0, 800.0), randomPolar(0.0, 0.3), randomPolar(1500.0, 6000.0),
+				POINTS_PER_SET);
+
+	printf("solTest: %ld term sets, %ld points, worst terms %d LSB (tolerance %d), "
+			"worst point %d LSB of Q14 (tolerance %d), %ld failures\n",
+			sets, points, worstTerms, TERMS_TOLERANCE, worstPoint, POINT_TOLERANCE, failures);
+	return failures ? 1 : 0;
+}